@@ -0,0 +1,415 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the host benchmarks
+ */
+
+/*
+ * Host benchmarks of the hot paths of the shell. Each result is one JSON
+ * object per line on stdout, so runs of two commits can be compared with
+ * any JSON tool. "--quick" shortens every benchmark, for smoke tests.
+ */
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "finsh.h"
+#include "msh.h"
+#include "msh_rpc.h"
+#include "shell.h"
+
+#define NAME_SIZE 16
+
+static double bench_min_ns = 50e6; /* run each benchmark at least this long */
+
+static uint64_t bench_bytes;  /* bytes written by the shell */
+static uint64_t bench_writes; /* calls to the output, each one a driver call on a board */
+
+static const char *script;    /* keystrokes fed to finsh_run() */
+static uint32_t script_size;
+static uint32_t script_pos;
+static uint64_t script_keys; /* keystrokes left */
+static jmp_buf script_done;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void count_output(const char *buf, uint32_t size) {
+    (void)buf;
+    bench_bytes += size;
+    bench_writes++;
+}
+
+static int script_getchar(void) {
+    int ch;
+
+    if (script_keys == 0) longjmp(script_done, 1);
+    script_keys--;
+
+    ch = (unsigned char)script[script_pos];
+    if (++script_pos == script_size) script_pos = 0;
+    return ch;
+}
+
+static int nop(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    return 0;
+}
+
+#ifdef FINSH_USING_REGISTRY
+static int nop_ctx(void *ctx, int argc, char **argv) {
+    (void)ctx;
+    return nop(argc, argv);
+}
+#endif
+
+/* a table of count commands named cmd00000, cmd00001, ... */
+static struct finsh_syscall *make_table(int count, char (**names)[NAME_SIZE]) {
+    struct finsh_syscall *table = calloc(count, sizeof(*table));
+    int i;
+
+    *names = calloc(count, NAME_SIZE);
+    for (i = 0; i < count; i++) {
+        snprintf((*names)[i], NAME_SIZE, "cmd%05d", i);
+        table[i].name = (*names)[i];
+#ifdef FINSH_USING_DESCRIPTION
+        table[i].desc = "synthetic";
+#endif
+        table[i].func = FINSH_SYSCALL_FUNC(nop);
+    }
+
+    return table;
+}
+
+static void report(const char *bench, const char *param, long value, uint64_t ops, uint64_t ns, const char *extra) {
+    printf("{\"bench\":\"%s\",\"%s\":%ld,\"ops\":%llu,\"ns_per_op\":%.2f%s}\n", bench, param, value, (unsigned long long)ops,
+           (double)ns / ops, extra ? extra : "");
+    fflush(stdout);
+}
+
+static void bench_lookup(int count) {
+    char (*names)[NAME_SIZE];
+    struct finsh_syscall *table = make_table(count, &names);
+    struct msh_target target;
+    uint64_t ops = 0, start, elapsed;
+    int i = 0;
+
+    finsh_system_function_init(table, table + count);
+
+    /* the names in a scattered order, so the average position is measured */
+    start = now_ns();
+    do {
+        int batch;
+
+        for (batch = 0; batch < 1000; batch++) {
+            msh_resolve(names[i], &target);
+            i = (i + 7919) % count;
+        }
+        ops += 1000;
+        elapsed = now_ns() - start;
+    } while (elapsed < bench_min_ns);
+    report("lookup_table", "commands", count, ops, elapsed, NULL);
+
+#ifdef FINSH_USING_REGISTRY
+    {
+        struct msh_cmd *cmds = calloc(count, sizeof(*cmds));
+
+        for (i = 0; i < count; i++) {
+            cmds[i].name = names[i];
+            cmds[i].func = nop_ctx;
+            msh_cmd_register(&cmds[i]);
+        }
+
+        ops = 0;
+        i = 0;
+        start = now_ns();
+        do {
+            int batch;
+
+            for (batch = 0; batch < 1000; batch++) {
+                msh_resolve(names[i], &target);
+                i = (i + 7919) % count;
+            }
+            ops += 1000;
+            elapsed = now_ns() - start;
+        } while (elapsed < bench_min_ns);
+        report("lookup_registry", "commands", count, ops, elapsed, NULL);
+
+        for (i = 0; i < count; i++) msh_cmd_unregister(&cmds[i]);
+        free(cmds);
+    }
+#endif
+
+    free(table);
+    free(names);
+}
+
+static void bench_complete(int count) {
+    char (*names)[NAME_SIZE];
+    struct finsh_syscall *table = make_table(count, &names);
+    char prefix[FINSH_CMD_SIZE + 1];
+    uint64_t ops = 0, start, elapsed;
+
+    finsh_system_function_init(table, table + count);
+
+    start = now_ns();
+    do {
+        memset(prefix, 0, sizeof(prefix));
+        strcpy(prefix, "cmd0000");
+        msh_auto_complete(prefix);
+        ops++;
+        elapsed = now_ns() - start;
+    } while (elapsed < bench_min_ns);
+    report("complete", "commands", count, ops, elapsed, NULL);
+
+    free(table);
+    free(names);
+}
+
+/* msh_exec() of a command with argc words, which is dominated by msh_split() */
+static void bench_exec(int argc) {
+    static const char *const words = "nop alpha beta \"gamma delta\" epsilon zeta eta";
+    struct finsh_syscall table[1];
+    char line[FINSH_CMD_SIZE + 1];
+    uint64_t ops = 0, start, elapsed;
+    uint32_t length = 0;
+    int i;
+
+    /* the first argc words of the line */
+    for (i = 0; i < argc; i++) {
+        while (words[length] == ' ') length++;
+        if (words[length] == '"') {
+            length++;
+            while (words[length] != '"') length++;
+            length++;
+        } else {
+            while (words[length] && words[length] != ' ') length++;
+        }
+    }
+
+    memset(table, 0, sizeof(table));
+    table[0].name = "nop";
+    table[0].func = FINSH_SYSCALL_FUNC(nop);
+    finsh_system_function_init(table, table + 1);
+
+    start = now_ns();
+    do {
+        int batch;
+
+        for (batch = 0; batch < 1000; batch++) {
+            memcpy(line, words, length);
+            line[length] = '\0';
+            msh_exec(line, length);
+        }
+        ops += 1000;
+        elapsed = now_ns() - start;
+    } while (elapsed < bench_min_ns);
+    report("exec_split", "argc", argc, ops, elapsed, NULL);
+}
+
+/* the cost and the output of each keystroke in the line editor */
+static void bench_keys(const char *name, const char *keys) {
+    struct finsh_syscall table[1];
+    volatile uint64_t keys_run = 0; /* kept across the longjmp out of finsh_run() */
+    uint64_t bytes, start, elapsed;
+    char extra[64];
+
+    memset(table, 0, sizeof(table));
+    table[0].name = "nop";
+    table[0].func = FINSH_SYSCALL_FUNC(nop);
+    finsh_system_function_init(table, table + 1);
+
+    script = keys;
+    script_size = strlen(keys);
+    script_pos = 0;
+
+    bytes = bench_bytes;
+    start = now_ns();
+    do {
+        /* whole scripts only, so every run leaves an empty line */
+        script_keys = script_size * 100;
+        keys_run += script_keys;
+        if (setjmp(script_done) == 0) finsh_run();
+        elapsed = now_ns() - start;
+    } while (elapsed < bench_min_ns);
+
+    /* finsh_run() prints a prompt when it starts, leave it out */
+    bytes = bench_bytes - bytes - (keys_run / script_size / 100) * (2 + strlen(FINSH_PROMPT));
+    snprintf(extra, sizeof(extra), ",\"bytes_per_key\":%.2f", (double)bytes / keys_run);
+    report(name, "script_chars", (long)script_size, keys_run, elapsed, extra);
+}
+
+/* a paste of lines commands, typed one key at a time or as a bracketed paste */
+static void bench_paste(const char *name, int lines, int bracketed) {
+    struct finsh_syscall table[1];
+    volatile uint64_t pastes = 0; /* kept across the longjmp out of finsh_run() */
+    uint64_t bytes, writes, start, elapsed;
+    char *keys, *end, extra[128];
+    int i;
+
+    memset(table, 0, sizeof(table));
+    table[0].name = "nop";
+    table[0].func = FINSH_SYSCALL_FUNC(nop);
+    finsh_system_function_init(table, table + 1);
+
+    keys = end = malloc(lines * 32 + 16);
+    if (bracketed) end += sprintf(end, "\x1b[200~");
+    for (i = 0; i < lines; i++) end += sprintf(end, "nop alpha beta %05d\r\n", i);
+    if (bracketed) end += sprintf(end, "\x1b[201~");
+
+    script = keys;
+    script_size = end - keys;
+    script_pos = 0;
+
+    bytes = bench_bytes;
+    writes = bench_writes;
+    start = now_ns();
+    do {
+        script_keys = script_size;
+        pastes++;
+        if (setjmp(script_done) == 0) finsh_run();
+        elapsed = now_ns() - start;
+    } while (elapsed < bench_min_ns);
+
+    bytes = bench_bytes - bytes - pastes * (2 + strlen(FINSH_PROMPT));
+    writes = bench_writes - writes - pastes * 2;
+    snprintf(extra, sizeof(extra), ",\"ns_per_line\":%.2f,\"bytes_per_key\":%.2f,\"writes_per_line\":%.2f",
+             (double)elapsed / (pastes * lines), (double)bytes / (pastes * script_size), (double)writes / (pastes * lines));
+    report(name, "lines", lines, pastes, elapsed, extra);
+
+    free(keys);
+}
+
+#ifdef FINSH_USING_RPC
+/* a command with a line of output, like most status commands */
+static int status(int argc, char **argv) {
+    FINSH_PRINTF("%s: %s ok\r\n", argv[0], argc > 1 ? argv[1] : "");
+    return 0;
+}
+
+/* one request frame, see msh_rpc.h */
+static uint32_t rpc_frame(uint8_t *frame, uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t len) {
+    uint16_t crc;
+
+    frame[0] = FINSH_RPC_SOF;
+    frame[1] = type;
+    frame[2] = seq & 0xFF;
+    frame[3] = seq >> 8;
+    frame[4] = len & 0xFF;
+    frame[5] = len >> 8;
+    memcpy(&frame[FINSH_RPC_HEADER_SIZE], payload, len);
+    crc = finsh_crc16(0xFFFF, &frame[1], FINSH_RPC_HEADER_SIZE - 1 + len);
+    frame[FINSH_RPC_HEADER_SIZE + len] = crc & 0xFF;
+    frame[FINSH_RPC_HEADER_SIZE + len + 1] = crc >> 8;
+
+    return FINSH_RPC_HEADER_SIZE + len + 2;
+}
+
+/* feed keys to finsh_run() count times, the bytes written are counted */
+static void run_script(const char *keys, uint32_t size, uint64_t count) {
+    script = keys;
+    script_size = size;
+    script_pos = 0;
+    script_keys = size * count;
+    if (setjmp(script_done) == 0) finsh_run();
+}
+
+static struct msh_target rpc_target; /* the rpc command of the FSymTab section */
+
+/* the same command over the loopback, typed as text or called as rpc frames */
+static void bench_rpc(const char *name, int rpc_mode) {
+    static const char line[] = "status sensor0\r";
+    static const uint8_t call[] = {1, 0, 1, 's', 'e', 'n', 's', 'o', 'r', '0', 0}; /* id 1, one argument */
+    struct finsh_syscall table[2];
+    uint8_t frame[64];
+    uint32_t frame_size;
+    volatile uint64_t calls = 0; /* kept across the longjmp out of finsh_run() */
+    uint64_t bytes, start, elapsed;
+    char extra[128];
+
+    memset(table, 0, sizeof(table));
+    table[0].name = "rpc";
+    table[0].func = FINSH_SYSCALL_FUNC(rpc_target.func);
+    table[1].name = "status";
+    table[1].func = FINSH_SYSCALL_FUNC(status);
+    finsh_system_function_init(table, table + 2);
+
+    if (rpc_mode) {
+        run_script("rpc\r", 4, 1);
+        frame_size = rpc_frame(frame, FINSH_RPC_CALL, 1, call, sizeof(call));
+    } else {
+        frame_size = sizeof(line) - 1;
+        memcpy(frame, line, frame_size);
+    }
+
+    bytes = bench_bytes;
+    start = now_ns();
+    do {
+        run_script((const char *)frame, frame_size, 100);
+        calls += 100;
+        elapsed = now_ns() - start;
+    } while (elapsed < bench_min_ns);
+
+    /* finsh_run() prints a prompt when it starts, leave it out */
+    bytes = bench_bytes - bytes - (calls / 100) * (2 + strlen(FINSH_PROMPT) + (rpc_mode ? 8 : 0));
+    snprintf(extra, sizeof(extra), ",\"calls_per_sec\":%.0f,\"bytes_in_per_call\":%u,\"bytes_out_per_call\":%.2f",
+             calls * 1e9 / elapsed, (unsigned int)frame_size, (double)bytes / calls);
+    report(name, "frame_bytes", (long)frame_size, calls, elapsed, extra);
+
+    if (rpc_mode) {
+        frame_size = rpc_frame(frame, FINSH_RPC_EXIT, 2, NULL, 0);
+        run_script((const char *)frame, frame_size, 1);
+    }
+}
+#endif /* FINSH_USING_RPC */
+
+int main(int argc, char **argv) {
+    static const int sizes[] = {10, 100, 1000, 10000};
+    finsh_shell_cfg_t cfg;
+    unsigned int i;
+
+    if (argc > 1 && strcmp(argv[1], "--quick") == 0) bench_min_ns = 1e6;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.echo_mode = 1;
+    cfg.get_char = script_getchar;
+    cfg.output = count_output;
+    finsh_system_init(&cfg);
+#ifdef FINSH_USING_RPC
+    /* before the benchmarks replace the command table */
+    msh_resolve("rpc", &rpc_target);
+#endif
+
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) bench_lookup(sizes[i]);
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) bench_complete(sizes[i]);
+    for (i = 1; i <= 7; i += 3) bench_exec(i);
+
+    /* typing and erasing, a line run through the dispatcher, editing in the middle */
+    bench_keys("keys_type_erase", "abcdefghijklmnopqrstuvwxyz\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b");
+    bench_keys("keys_line", "nop alpha beta gamma\r");
+    bench_keys("keys_insert_mid", "nop alpha beta\x1b[D\x1b[D\x1b[D\x1b[Dxyz\r");
+
+    /* 10k lines pasted into the terminal */
+    bench_paste("paste_typed", 10000, 0);
+    bench_paste("paste_bracketed", 10000, 1);
+
+#ifdef FINSH_USING_RPC
+    /* the throughput of a command with output, as a typed line and as an rpc call */
+    bench_rpc("loopback_text", 0);
+    bench_rpc("loopback_rpc", 1);
+#endif
+
+    return 0;
+}
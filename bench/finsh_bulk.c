@@ -0,0 +1,414 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the bulk loopback benchmark
+ */
+
+/*
+ * Moves data through the bulk mode of the shell over a simulated serial
+ * link and compares the throughput with the rate of the link:
+ *
+ *     finsh_bulk [--quick]
+ *
+ * The board is the shell itself, running "sink" to upload and "source" to
+ * download. The host is a reference implementation of the protocol in
+ * msh_bulk.h. Both ends share a virtual clock, each byte takes 10 bits of
+ * the baud rate (8N1) plus the latency of the link, and bytes can be
+ * corrupted on the way to check the recovery. Each result is one JSON
+ * object per line, the exit code is 1 when data was lost or corrupted.
+ * cpu_mb_per_sec is the rate of the simulation itself, both ends on one
+ * core, which bounds what the board code could keep up with.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "msh_bulk.h"
+#include "msh_rpc.h"
+#include "shell.h"
+
+#define NEVER      UINT64_MAX
+#define GIVE_UP_NS (600 * 1000000000ULL) /* of virtual time */
+
+#define BOARD_PENDING 1 /* board.result before the transfer ends */
+
+/* one direction of the link, bytes with the time they arrive */
+struct link {
+    uint8_t *buf;
+    uint64_t *arrive;
+    size_t cap, head, tail;
+    uint64_t free; /* when the line is free for the next byte */
+};
+
+static struct {
+    uint64_t byte_ns;
+    uint64_t latency_ns;
+    uint32_t corrupt_ppm;
+} cfg_link;
+
+static uint64_t now; /* virtual ns */
+static uint32_t random_state = 1;
+static struct link h2d, d2h; /* host to device, device to host */
+
+static uint32_t xorshift(void) {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+static void link_push(struct link *link, const uint8_t *buf, size_t size) {
+    while (size--) {
+        uint8_t ch = *buf++;
+
+        if (link->tail == link->cap) {
+            size_t cap = link->cap ? link->cap * 2 : 4096;
+            uint8_t *buf_new = realloc(link->buf, cap);
+            uint64_t *arrive_new;
+
+            if (buf_new) link->buf = buf_new;
+            arrive_new = buf_new ? realloc(link->arrive, cap * sizeof(uint64_t)) : NULL;
+            if (arrive_new == NULL) {
+                fprintf(stderr, "link: out of memory at %lu bytes\n", (unsigned long)link->cap);
+                exit(2);
+            }
+            link->arrive = arrive_new;
+            link->cap = cap;
+        }
+        if (cfg_link.corrupt_ppm && xorshift() % 1000000 < cfg_link.corrupt_ppm) ch ^= 1 << (xorshift() % 8);
+
+        if (link->free < now) link->free = now;
+        link->free += cfg_link.byte_ns;
+        link->buf[link->tail] = ch;
+        link->arrive[link->tail] = link->free + cfg_link.latency_ns;
+        link->tail++;
+    }
+}
+
+static int link_pop(struct link *link) {
+    if (link->head == link->tail || link->arrive[link->head] > now) return -1;
+
+    return link->buf[link->head++];
+}
+
+static uint64_t link_next(struct link *link) { return link->head == link->tail ? NEVER : link->arrive[link->head]; }
+
+static void link_reset(struct link *link) { link->head = link->tail = link->free = 0; }
+
+/* the data of a transfer, the same at the board and the host */
+static uint8_t pattern(uint32_t offset) { return (uint8_t)((offset * 2654435761u) >> 24); }
+
+/* the host side of the protocol */
+static struct {
+    int upload;
+    uint32_t size;
+    uint32_t blocks;
+    uint16_t block;
+    uint8_t window;
+
+    uint32_t base, next; /* upload: first block not acked, next block to send; download: next block expected */
+    uint32_t received;
+    uint8_t ready, end_sent, nak_sent, done;
+    uint64_t deadline;
+    uint64_t timeout_ns;
+
+    uint8_t stat;
+    uint16_t pos, len;
+    uint8_t frame[FINSH_BULK_HEADER_SIZE + 0xFFFF + 2];
+
+    uint32_t resent, corrupt;
+} host;
+
+static struct {
+    int result;
+    uint32_t size;
+    uint32_t corrupt;
+} board;
+
+static void host_frame(uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t len) {
+    uint8_t frame[FINSH_BULK_HEADER_SIZE + 0xFFFF + 2];
+    uint16_t crc;
+
+    frame[0] = FINSH_BULK_SOF;
+    frame[1] = type;
+    frame[2] = seq & 0xFF;
+    frame[3] = seq >> 8;
+    frame[4] = len & 0xFF;
+    frame[5] = len >> 8;
+    memcpy(&frame[FINSH_BULK_HEADER_SIZE], payload, len);
+    crc = finsh_crc16(0xFFFF, &frame[1], FINSH_BULK_HEADER_SIZE - 1 + len);
+    frame[FINSH_BULK_HEADER_SIZE + len] = crc & 0xFF;
+    frame[FINSH_BULK_HEADER_SIZE + len + 1] = crc >> 8;
+    link_push(&h2d, frame, FINSH_BULK_HEADER_SIZE + len + 2);
+}
+
+static void host_pump(void) {
+    uint8_t payload[0xFFFF];
+
+    while (host.next - host.base < host.window && host.next < host.blocks) {
+        uint32_t offset = host.next * host.block, i;
+        uint16_t len = host.size - offset < host.block ? host.size - offset : host.block;
+
+        for (i = 0; i < len; i++) payload[i] = pattern(offset + i);
+        host_frame(FINSH_BULK_DATA, (uint16_t)host.next, payload, len);
+        host.next++;
+    }
+    if (host.base == host.blocks && !host.end_sent) {
+        host.end_sent = 1;
+        host_frame(FINSH_BULK_END, (uint16_t)host.blocks, NULL, 0);
+    }
+    host.deadline = now + host.timeout_ns;
+}
+
+static void host_handle(uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t len) {
+    uint32_t count = host.base + (int16_t)(uint16_t)(seq - (uint16_t)host.base);
+    uint32_t i;
+
+    if (type == FINSH_BULK_CANCEL) {
+        host.done = 1;
+        return;
+    }
+
+    if (host.upload) {
+        if (type == FINSH_BULK_ACK && !host.ready && seq == 0 && len == 3) {
+            host.ready = 1;
+            host.block = payload[0] | (payload[1] << 8);
+            host.window = payload[2];
+            host.blocks = (host.size + host.block - 1) / host.block;
+            host_pump();
+        } else if (type == FINSH_BULK_ACK && host.end_sent && count == host.blocks + 1) {
+            host.done = 1;
+        } else if (type == FINSH_BULK_ACK && count > host.base && count <= host.next) {
+            host.base = count;
+            host_pump();
+        } else if (type == FINSH_BULK_NAK && count >= host.base && count <= host.next) {
+            host.resent += host.next - count;
+            host.base = host.next = count;
+            host.end_sent = 0;
+            host_pump();
+        }
+        return;
+    }
+
+    /* download, the same rules as the board in msh_bulk.c */
+    host.deadline = now + host.timeout_ns;
+    if (type == FINSH_BULK_DATA && count != host.base) host.resent++;
+    if (type == FINSH_BULK_DATA && count == host.base) {
+        for (i = 0; i < len; i++) host.corrupt += payload[i] != pattern(host.received + i);
+        host.received += len;
+        host.base++;
+        host.nak_sent = 0;
+        host_frame(FINSH_BULK_ACK, (uint16_t)host.base, NULL, 0);
+    } else if (type == FINSH_BULK_DATA && count < host.base) {
+        host_frame(FINSH_BULK_ACK, (uint16_t)host.base, NULL, 0);
+    } else if (type == FINSH_BULK_END && count == host.base) {
+        host_frame(FINSH_BULK_ACK, (uint16_t)(host.base + 1), NULL, 0);
+        host.done = 1;
+    } else if ((type == FINSH_BULK_DATA || type == FINSH_BULK_END) && !host.nak_sent) {
+        host.nak_sent = 1;
+        host_frame(FINSH_BULK_NAK, (uint16_t)host.base, NULL, 0);
+    }
+}
+
+static void host_input(uint8_t ch) {
+    uint16_t crc;
+
+    switch (host.stat) {
+        case 0:
+            if (ch == FINSH_BULK_SOF) {
+                host.stat = 1;
+                host.pos = 1;
+            }
+            return;
+        case 1:
+            host.frame[host.pos++] = ch;
+            if (host.pos < FINSH_BULK_HEADER_SIZE) return;
+            host.len = host.frame[4] | (host.frame[5] << 8);
+            host.stat = 2;
+            return;
+        default:
+            host.frame[host.pos++] = ch;
+            if (host.pos < FINSH_BULK_HEADER_SIZE + host.len + 2) return;
+            host.stat = 0;
+            break;
+    }
+
+    crc = finsh_crc16(0xFFFF, &host.frame[1], FINSH_BULK_HEADER_SIZE - 1 + host.len);
+    if (crc != (host.frame[host.pos - 2] | (host.frame[host.pos - 1] << 8))) {
+        /* the board goes back to the last ACK when it gets nothing */
+        if (!host.upload && !host.nak_sent) {
+            host.nak_sent = 1;
+            host_frame(FINSH_BULK_NAK, (uint16_t)host.base, NULL, 0);
+        }
+        return;
+    }
+    host_handle(host.frame[1], host.frame[2] | (host.frame[3] << 8), &host.frame[FINSH_BULK_HEADER_SIZE], host.len);
+}
+
+static void host_timeout(void) {
+    if (host.upload) {
+        /* nothing acked for a while, go back to the last ACK */
+        host.resent += host.next - host.base;
+        host.next = host.base;
+        host.end_sent = 0;
+        if (host.ready) host_pump();
+    } else {
+        host.nak_sent = 1;
+        host_frame(FINSH_BULK_NAK, (uint16_t)host.base, NULL, 0);
+    }
+    host.deadline = now + host.timeout_ns;
+}
+
+static int board_getchar(void) {
+    uint64_t next;
+    int ch;
+
+    while ((ch = link_pop(&d2h)) >= 0) host_input(ch);
+    if (now >= host.deadline && !host.done) host_timeout();
+
+    ch = link_pop(&h2d);
+    if (ch >= 0) return ch;
+    if (host.done && board.result != BOARD_PENDING && h2d.head == h2d.tail) return FINSH_GETCHAR_EOF;
+    if (now > GIVE_UP_NS) return FINSH_GETCHAR_EOF;
+
+    /* nothing to read yet, move the clock to the next event or let the board time out */
+    next = link_next(&h2d);
+    if (link_next(&d2h) < next) next = link_next(&d2h);
+    if (!host.done && host.deadline < next) next = host.deadline;
+    if (next == NEVER) next = now + 1000000;
+    if (next > now) now = next;
+
+    return -1;
+}
+
+static uint32_t board_tick(void) { return (uint32_t)(now / (1000000000 / FINSH_TICK_PER_SECOND)); }
+
+static void board_output(const char *buf, uint32_t size) { link_push(&d2h, (const uint8_t *)buf, size); }
+
+static int sink_recv(void *ctx, uint32_t offset, const uint8_t *data, uint32_t size) {
+    uint32_t i;
+
+    (void)ctx;
+    for (i = 0; i < size; i++) board.corrupt += data[i] != pattern(offset + i);
+    return 0;
+}
+
+static int source_send(void *ctx, uint32_t offset, uint8_t *buf, uint32_t size) {
+    uint32_t total = *(uint32_t *)ctx, i;
+
+    if (offset >= total) return 0;
+    if (size > total - offset) size = total - offset;
+    for (i = 0; i < size; i++) buf[i] = pattern(offset + i);
+    return size;
+}
+
+static void bulk_done(void *ctx, int result, uint32_t size) {
+    (void)ctx;
+    board.result = result;
+    board.size = size;
+    FINSH_PRINTF("bulk %d, %lu bytes\r\n", result, (unsigned long)size);
+}
+
+static int sink(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    return finsh_bulk_recv(sink_recv, bulk_done, NULL);
+}
+MSH_CMD_EXPORT(sink, receive data in bulk mode);
+
+static uint32_t source_size;
+static int source(int argc, char **argv) {
+    if (argc < 2) return -1;
+
+    source_size = strtoul(argv[1], NULL, 0);
+    return finsh_bulk_send(source_send, bulk_done, &source_size);
+}
+MSH_CMD_EXPORT(source, send data in bulk mode);
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* one transfer, 0 when every byte arrived intact */
+static int run(int upload, uint32_t size, uint32_t baud, uint32_t latency_us, uint32_t corrupt_ppm) {
+    finsh_shell_cfg_t cfg;
+    char line[32];
+    uint64_t start, wall, link_bytes;
+    double seconds, rate, link_rate;
+    int ok;
+
+    cfg_link.byte_ns = 10000000000ULL / baud;
+    cfg_link.latency_ns = (uint64_t)latency_us * 1000;
+    cfg_link.corrupt_ppm = corrupt_ppm;
+    link_reset(&h2d);
+    link_reset(&d2h);
+    now = 0;
+
+    memset(&host, 0, sizeof(host));
+    memset(&board, 0, sizeof(board));
+    host.upload = upload;
+    host.size = size;
+    /* a full window and its ACKs, twice */
+    host.timeout_ns = 2 * (FINSH_BULK_WINDOW + 1) * (FINSH_BULK_BLOCK + 8) * cfg_link.byte_ns + 4 * cfg_link.latency_ns;
+    host.deadline = NEVER;
+    board.result = BOARD_PENDING;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.get_char = board_getchar;
+    cfg.get_tick = board_tick;
+    cfg.output = board_output;
+    finsh_system_init(&cfg);
+
+    /* the command line is typed without errors */
+    snprintf(line, sizeof(line), upload ? "sink\r" : "source %lu\r", (unsigned long)size);
+    cfg_link.corrupt_ppm = 0;
+    link_push(&h2d, (const uint8_t *)line, strlen(line));
+    cfg_link.corrupt_ppm = corrupt_ppm;
+
+    start = now_ns();
+    finsh_run();
+    wall = now_ns() - start;
+
+    ok = board.result == FINSH_BULK_OK && board.size == size && board.corrupt == 0 && host.corrupt == 0 &&
+         (upload || host.received == size);
+    seconds = now / 1e9;
+    rate = size / seconds;
+    link_rate = baud / 10.0;
+    link_bytes = upload ? h2d.tail : d2h.tail;
+    printf("{\"name\":\"bulk_%s\",\"bytes\":%lu,\"baud\":%lu,\"latency_us\":%lu,\"corrupt_ppm\":%lu,"
+           "\"seconds\":%.6f,\"bytes_per_sec\":%.0f,\"link_efficiency\":%.3f,\"wire_bytes\":%llu,\"resent_blocks\":%lu,"
+           "\"cpu_mb_per_sec\":%.1f,\"ok\":%s}\n",
+           upload ? "upload" : "download", (unsigned long)size, (unsigned long)baud, (unsigned long)latency_us,
+           (unsigned long)corrupt_ppm, seconds, rate, rate / link_rate, (unsigned long long)link_bytes,
+           (unsigned long)host.resent, wall ? size / (wall / 1e3) : 0, ok ? "true" : "false");
+
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    static const uint32_t bauds[] = {115200, 921600, 3000000};
+    uint32_t size = 1 << 20;
+    int failed = 0, upload;
+    unsigned int i;
+
+    if (argc > 1 && strcmp(argv[1], "--quick") == 0) size = 64 << 10;
+
+    for (upload = 1; upload >= 0; upload--) {
+        for (i = 0; i < sizeof(bauds) / sizeof(bauds[0]); i++) failed |= run(upload, size, bauds[i], 0, 0);
+
+        /* a USB serial adapter, and a noisy line */
+        failed |= run(upload, size, 921600, 1000, 0);
+        failed |= run(upload, size, 115200, 0, 20);
+    }
+
+    return failed;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the printf benchmark
+ */
+
+/*
+ * The speed of finsh_printf() on the formats the shell prints, with the
+ * output thrown away:
+ *
+ *     finsh_printf [--quick]
+ *
+ * It is built twice, finsh_printf with the small printf of the shell and
+ * finsh_printf_libc with FINSH_USING_LIBC_PRINTF, the "printf" field tells
+ * them apart. Each result is one JSON object per line, with the bytes and
+ * the output calls of one call. The size of both variants is printed by
+ * the finsh_printf_size test.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "shell.h"
+
+#ifdef FINSH_USING_LIBC_PRINTF
+#define PRINTF_NAME "libc"
+#else
+#define PRINTF_NAME "finsh"
+#endif
+
+static double bench_min_ns = 50e6; /* run each case at least this long */
+
+static uint64_t bench_bytes;
+static uint64_t bench_writes;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void count_output(const char *buf, uint32_t size) {
+    (void)buf;
+    bench_bytes += size;
+    bench_writes++;
+}
+
+static int no_char(void) { return -1; }
+
+static void report(const char *bench, uint64_t ops, uint64_t ns) {
+    printf("{\"bench\":\"%s\",\"printf\":\"%s\",\"ops\":%llu,\"ns_per_op\":%.2f,\"bytes_per_op\":%.1f,"
+           "\"writes_per_op\":%.1f}\n",
+           bench, PRINTF_NAME, (unsigned long long)ops, (double)ns / ops, (double)bench_bytes / ops,
+           (double)bench_writes / ops);
+    fflush(stdout);
+}
+
+/* runs the statement in batches of 1000 until bench_min_ns has passed */
+#define BENCH(name, stmt)                                              \
+    do {                                                               \
+        uint64_t ops = 0, start, elapsed;                              \
+        int batch;                                                     \
+                                                               \
+        bench_bytes = bench_writes = 0;                                \
+        start = now_ns();                                              \
+        do {                                                           \
+            for (batch = 0; batch < 1000; batch++) stmt;               \
+            ops += 1000;                                               \
+            elapsed = now_ns() - start;                                \
+        } while (elapsed < bench_min_ns);                              \
+        report(name, ops, elapsed);                                    \
+    } while (0)
+
+int main(int argc, char **argv) {
+    volatile unsigned long addr = 0x20001000UL;
+    volatile int value = -42;
+    finsh_shell_cfg_t cfg;
+
+    if (argc > 1 && strcmp(argv[1], "--quick") == 0) bench_min_ns = 1e6;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.get_char = no_char;
+    cfg.output = count_output;
+    finsh_system_init(&cfg);
+
+    /* a row of the help table, the most common output of the shell */
+    BENCH("printf_help_row", finsh_printf("%-16s - %s\r\n", "version", "show finsh version information"));
+    /* a line of a memory dump */
+    BENCH("printf_hex_row", finsh_printf("%08lx: %02x %02x %02x %02x %02x %02x %02x %02x\r\n", addr, 0x12, 0x34, 0x56,
+                                         0x78, 0x9a, 0xbc, 0xde, 0xf0));
+    /* numbers with width and precision */
+    BENCH("printf_numbers", finsh_printf("[%5d] [%.3d] [%-8u] [%lld]\r\n", value, value, 42u, -1234567890123LL));
+    /* an output longer than FINSH_CONSOLEBUF_SIZE */
+    BENCH("printf_long", finsh_printf("%-200s|%d\r\n", "wide", value));
+
+    return 0;
+}
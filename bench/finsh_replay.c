@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the replay driver
+ */
+
+/*
+ * Records a session typed on stdin, or replays a recording and checks the
+ * output is byte-identical:
+ *
+ *     finsh_replay record session.fsr < keys
+ *     finsh_replay play [--realtime] session.fsr
+ *
+ * The result of a replay is one JSON object on stdout, the exit code is 1
+ * when the output differs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "msh_replay.h"
+
+static FILE *record_file;
+
+static uint32_t host_tick(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * FINSH_TICK_PER_SECOND + (uint64_t)ts.tv_nsec * FINSH_TICK_PER_SECOND / 1000000000);
+}
+
+static int stdin_getchar(void) {
+    unsigned char ch;
+
+    return read(0, &ch, 1) == 1 ? ch : FINSH_GETCHAR_EOF;
+}
+
+static void stdout_output(const char *buf, uint32_t size) { fwrite(buf, 1, size, stdout); }
+
+static void file_write(const void *buf, uint32_t size) { fwrite(buf, 1, size, record_file); }
+
+static int record(const char *path, finsh_shell_cfg_t *cfg) {
+    record_file = fopen(path, "wb");
+    if (record_file == NULL) {
+        perror(path);
+        return 2;
+    }
+
+    cfg->get_char = stdin_getchar;
+    cfg->output = stdout_output;
+    finsh_system_init(cfg);
+    finsh_record_start(file_write);
+    finsh_run();
+    finsh_record_stop();
+
+    fclose(record_file);
+    return 0;
+}
+
+static int play(const char *path, int realtime, finsh_shell_cfg_t *cfg) {
+    struct finsh_replay replay;
+    uint8_t *data;
+    long size;
+    double seconds;
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL) {
+        perror(path);
+        return 2;
+    }
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    data = malloc(size > 0 ? size : 1);
+    if (data == NULL || fread(data, 1, size, file) != (size_t)size) {
+        fprintf(stderr, "%s: read failed\n", path);
+        return 2;
+    }
+    fclose(file);
+
+    memset(&replay, 0, sizeof(replay));
+    replay.data = data;
+    replay.size = size;
+    replay.realtime = realtime;
+    finsh_replay(cfg, &replay);
+
+    seconds = (double)replay.ticks / FINSH_TICK_PER_SECOND;
+    printf("{\"recording\":\"%s\",\"realtime\":%s,\"keys\":%lu,\"commands\":%lu,\"seconds\":%.6f,"
+           "\"keys_per_sec\":%.0f,\"commands_per_sec\":%.0f,\"match\":%s,\"mismatch\":%lu}\n",
+           path, realtime ? "true" : "false", (unsigned long)replay.keys, (unsigned long)replay.commands, seconds,
+           seconds > 0 ? replay.keys / seconds : 0, seconds > 0 ? replay.commands / seconds : 0,
+           replay.match ? "true" : "false", (unsigned long)replay.mismatch);
+
+    free(data);
+    return replay.match ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    finsh_shell_cfg_t cfg;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.echo_mode = 1;
+    cfg.get_tick = host_tick;
+
+    if (argc == 3 && strcmp(argv[1], "record") == 0) return record(argv[2], &cfg);
+    if (argc == 3 && strcmp(argv[1], "play") == 0) return play(argv[2], 0, &cfg);
+    if (argc == 4 && strcmp(argv[1], "play") == 0 && strcmp(argv[2], "--realtime") == 0) return play(argv[3], 1, &cfg);
+
+    fprintf(stderr, "Usage: %s record <file> | play [--realtime] <file>\n", argv[0]);
+    return 2;
+}
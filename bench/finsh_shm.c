@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the shared memory benchmark
+ */
+
+/*
+ * Runs the same command in a forked shell through the shared memory
+ * channel and as a line typed over a unix socket, the usual way a host
+ * process drives a local shell:
+ *
+ *     finsh_shm [--quick]
+ *
+ * Each result is one JSON object per line with the round trip time of a
+ * command with one line of output. The exit code is 1 when a round trip
+ * failed or returned the wrong output.
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#include "finsh.h"
+#include "msh_shm.h"
+#include "shell.h"
+
+#define REPLY "status: sensor0 ok\r\n"
+
+static double bench_min_ns = 500e6; /* run each benchmark at least this long */
+static int sock_fd;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int status(int argc, char **argv) {
+    FINSH_PRINTF("%s: %s ok\r\n", argv[0], argc > 1 ? argv[1] : "");
+    return 0;
+}
+MSH_CMD_EXPORT(status, print one line);
+
+/* the shell sleeps in the channel instead of get_char, finsh_run() polls it */
+static int shm_getchar(void) {
+    msh_shm_wait(100);
+    return -1;
+}
+
+static int sock_getchar(void) {
+    unsigned char ch;
+
+    return read(sock_fd, &ch, 1) == 1 ? ch : FINSH_GETCHAR_EOF;
+}
+
+static void sock_output(const char *buf, uint32_t size) {
+    while (size) {
+        ssize_t count = write(sock_fd, buf, size);
+
+        if (count <= 0) _exit(1);
+        buf += count;
+        size -= count;
+    }
+}
+
+static void null_output(const char *buf, uint32_t size) {
+    (void)buf;
+    (void)size;
+}
+
+static pid_t spawn_shell(int use_shm) {
+    finsh_shell_cfg_t cfg;
+    pid_t pid = fork();
+
+    if (pid != 0) return pid;
+
+    memset(&cfg, 0, sizeof(cfg));
+    if (use_shm) {
+        cfg.get_char = shm_getchar;
+        cfg.output = null_output;
+    } else {
+        /* the host sees the echo, the output and the prompt */
+        cfg.echo_mode = 1;
+        cfg.prompt_mode = 1;
+        cfg.get_char = sock_getchar;
+        cfg.output = sock_output;
+    }
+    finsh_system_init(&cfg);
+    finsh_run();
+    _exit(0);
+}
+
+static void report(const char *bench, uint64_t ops, uint64_t ns) {
+    printf("{\"bench\":\"%s\",\"ops\":%llu,\"ns_per_op\":%.2f,\"calls_per_sec\":%.0f}\n", bench, (unsigned long long)ops,
+           (double)ns / ops, ops * 1e9 / ns);
+    fflush(stdout);
+}
+
+static char shm_reply[256];
+static uint32_t shm_reply_size;
+
+static void shm_collect(const char *buf, uint32_t size, void *arg) {
+    (void)arg;
+    if (size > sizeof(shm_reply) - shm_reply_size) size = sizeof(shm_reply) - shm_reply_size;
+    memcpy(&shm_reply[shm_reply_size], buf, size);
+    shm_reply_size += size;
+}
+
+static int bench_shm(void) {
+    struct finsh_shm *shm;
+    uint64_t ops = 0, start, elapsed;
+    int ret, failed = 0;
+    pid_t pid;
+
+    if (msh_shm_init("/finsh_bench") != 0) {
+        fprintf(stderr, "msh_shm_init failed\n");
+        return 1;
+    }
+    pid = spawn_shell(1);
+    shm = msh_shm_open("/finsh_bench");
+
+    start = now_ns();
+    do {
+        shm_reply_size = 0;
+        if (msh_shm_exec(shm, "status sensor0", shm_collect, NULL, &ret, 1000) != 0 || ret != 0 ||
+            shm_reply_size != sizeof(REPLY) - 1 || memcmp(shm_reply, REPLY, shm_reply_size) != 0)
+            failed = 1;
+        ops++;
+        elapsed = now_ns() - start;
+    } while (elapsed < bench_min_ns && !failed);
+    report("shm_exec", ops, elapsed);
+
+    msh_shm_close(shm);
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+    msh_shm_deinit();
+
+    return failed;
+}
+
+static int bench_socket(void) {
+    static const char line[] = "status sensor0\r";
+    char reply[256], prompt[16];
+    uint64_t ops = 0, start, elapsed;
+    int fds[2], failed = 0;
+    size_t size, expect;
+    pid_t pid;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) return 1;
+    sock_fd = fds[1];
+    pid = spawn_shell(0);
+    close(fds[1]);
+    sock_fd = fds[0];
+
+    /* the reply is the echo, the output and the next prompt */
+    snprintf(prompt, sizeof(prompt), "msh >");
+    expect = sizeof(line) - 2 + strlen("\r\n") + sizeof(REPLY) - 1 + strlen(prompt);
+
+    /* the banner of finsh_run() */
+    for (size = 0; size < 2 + strlen(prompt);) size += read(sock_fd, reply + size, sizeof(reply) - size);
+
+    start = now_ns();
+    do {
+        if (write(sock_fd, line, sizeof(line) - 1) != sizeof(line) - 1) failed = 1;
+        for (size = 0; !failed && size < expect;) {
+            ssize_t count = read(sock_fd, reply + size, sizeof(reply) - size);
+
+            if (count <= 0) failed = 1;
+            size += count;
+        }
+        if (size != expect || memcmp(reply + sizeof(line), REPLY, sizeof(REPLY) - 1) != 0) failed = 1;
+        ops++;
+        elapsed = now_ns() - start;
+    } while (elapsed < bench_min_ns && !failed);
+    report("socket_exec", ops, elapsed);
+
+    close(sock_fd);
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    int failed = 0;
+
+    if (argc > 1 && strcmp(argv[1], "--quick") == 0) bench_min_ns = 10e6;
+
+    failed |= bench_shm();
+    failed |= bench_socket();
+
+    return failed;
+}
@@ -48,58 +48,128 @@
 #error not supported tool chain
 #endif
 
+/* lets GCC and Clang check the arguments of the printf-like functions against their format */
+#if defined(__GNUC__) || defined(__clang__)
+#define FINSH_PRINTF_FORMAT(fmt, args) __attribute__((format(printf, fmt, args)))
+#else
+#define FINSH_PRINTF_FORMAT(fmt, args)
+#endif
+
 #if defined(_MSC_VER)
 #pragma section("FSymTab$f", read)
 #endif
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef long (*syscall_func)(void);
 
+/* commands are stored as syscall_func, the cast goes through the generic void (*)(void) */
+#define FINSH_SYSCALL_FUNC(func) ((syscall_func)(void (*)(void))(func))
+
 #ifdef __TI_COMPILER_VERSION__
 #define __TI_FINSH_EXPORT_FUNCTION(f) PRAGMA(DATA_SECTION(f, "FSymTab"))
 #endif
-#ifdef FINSH_USING_DESCRIPTION
+
+/* the typed argument schema of a command, see msh_args.h */
+#ifdef FINSH_USING_ARGS
+#define FINSH_SYSCALL_ARGS(args) , args
+#else
+#define FINSH_SYSCALL_ARGS(args)
+#endif
+
+#ifdef FINSH_USING_REGISTRY
+typedef int (*msh_cmd_func_t)(void *ctx, int argc, char **argv);
+
+/* a command registered at run time, the structure is owned by the caller */
+struct msh_cmd {
+    const char *name;
+    const char *desc;
+    msh_cmd_func_t func;
+    void *ctx; /* passed to func, e.g. the object the command works on */
+#if defined(FINSH_USING_ARGS)
+    const struct msh_cmd_args *args; /* typed argument schema, NULL for plain commands */
+#endif
+    uint16_t id; /* set by msh_cmd_register(), see MSH_CMD_ID_BASE */
+};
+
+/*
+ * The ids of registered commands start at MSH_CMD_ID_BASE, below it is the
+ * index in the command table. An id stays the same while the command is
+ * registered and is not given to another command until the ids wrap.
+ */
+#define MSH_CMD_ID_BASE 0x8000
+
+int msh_cmd_register(struct msh_cmd *cmd);
+int msh_cmd_unregister(struct msh_cmd *cmd);
+struct msh_cmd *msh_cmd_find(const char *name, int size);
+int msh_cmd_count(void);
+struct msh_cmd *msh_cmd_at(int index);
+struct msh_cmd *msh_cmd_by_id(uint16_t id);
+#endif /* FINSH_USING_REGISTRY */
+
+#if defined(FINSH_NO_SYMTAB)
+/*
+ * Without the FSymTab section the exported commands register themselves
+ * from a constructor, which survives LTO and --gc-sections on hosted builds.
+ */
+#if !defined(FINSH_USING_REGISTRY) || !defined(__GNUC__)
+#error "FINSH_NO_SYMTAB needs FINSH_USING_REGISTRY and a GNU compatible compiler"
+#endif
+#define MSH_FUNCTION_EXPORT_CMD_EX(name, cmd, desc, args)                                                    \
+    static int __fctx_##cmd(void *ctx, int argc, char **argv) {                                             \
+        (void)ctx;                                                                                           \
+        return ((int (*)(int, char **))(name))(argc, argv);                                                  \
+    }                                                                                                        \
+    static struct msh_cmd __fcmd_##cmd = {#cmd, #desc, __fctx_##cmd, 0 FINSH_SYSCALL_ARGS(args), 0};        \
+    __attribute__((constructor)) static void __freg_##cmd(void) { msh_cmd_register(&__fcmd_##cmd); }
+
+#elif defined(FINSH_USING_DESCRIPTION)
 #ifdef _MSC_VER
-#define MSH_FUNCTION_EXPORT_CMD(name, cmd, desc) \
-    const char __fsym_##cmd##_name[] = #cmd;     \
-    const char __fsym_##cmd##_desc[] = #desc;    \
-    __declspec(allocate("FSymTab$f")) const struct finsh_syscall __fsym_##cmd = {__fsym_##cmd##_name, __fsym_##cmd##_desc, (syscall_func) & name};
+#define MSH_FUNCTION_EXPORT_CMD_EX(name, cmd, desc, args) \
+    const char __fsym_##cmd##_name[] = #cmd;              \
+    const char __fsym_##cmd##_desc[] = #desc;             \
+    __declspec(allocate("FSymTab$f")) const struct finsh_syscall __fsym_##cmd = {__fsym_##cmd##_name, __fsym_##cmd##_desc, FINSH_SYSCALL_FUNC(name) FINSH_SYSCALL_ARGS(args)};
 #pragma comment(linker, "/merge:FSymTab=mytext")
 
 #elif defined(__TI_COMPILER_VERSION__)
-#define MSH_FUNCTION_EXPORT_CMD(name, cmd, desc) \
-    __TI_FINSH_EXPORT_FUNCTION(__fsym_##cmd);    \
-    const char __fsym_##cmd##_name[] = #cmd;     \
-    const char __fsym_##cmd##_desc[] = #desc;    \
-    const struct finsh_syscall __fsym_##cmd = {__fsym_##cmd##_name, __fsym_##cmd##_desc, (syscall_func) & name};
+#define MSH_FUNCTION_EXPORT_CMD_EX(name, cmd, desc, args) \
+    __TI_FINSH_EXPORT_FUNCTION(__fsym_##cmd);             \
+    const char __fsym_##cmd##_name[] = #cmd;              \
+    const char __fsym_##cmd##_desc[] = #desc;             \
+    const struct finsh_syscall __fsym_##cmd = {__fsym_##cmd##_name, __fsym_##cmd##_desc, FINSH_SYSCALL_FUNC(name) FINSH_SYSCALL_ARGS(args)};
 
 #else
-#define MSH_FUNCTION_EXPORT_CMD(name, cmd, desc)                            \
+#define MSH_FUNCTION_EXPORT_CMD_EX(name, cmd, desc, args)                   \
     const char __fsym_##cmd##_name[] FINSH_SECTION(".rodata.name") = #cmd;  \
     const char __fsym_##cmd##_desc[] FINSH_SECTION(".rodata.name") = #desc; \
-    FINSH_USED const struct finsh_syscall __fsym_##cmd FINSH_SECTION("FSymTab") = {__fsym_##cmd##_name, __fsym_##cmd##_desc, (syscall_func) & name};
+    FINSH_USED const struct finsh_syscall __fsym_##cmd FINSH_SECTION("FSymTab") = {__fsym_##cmd##_name, __fsym_##cmd##_desc, FINSH_SYSCALL_FUNC(name) FINSH_SYSCALL_ARGS(args)};
 
 #endif
 #else
 #ifdef _MSC_VER
-#define MSH_FUNCTION_EXPORT_CMD(name, cmd, desc) \
-    const char __fsym_##cmd##_name[] = #cmd;     \
-    __declspec(allocate("FSymTab$f")) const struct finsh_syscall __fsym_##cmd = {__fsym_##cmd##_name, (syscall_func) & name};
+#define MSH_FUNCTION_EXPORT_CMD_EX(name, cmd, desc, args) \
+    const char __fsym_##cmd##_name[] = #cmd;              \
+    __declspec(allocate("FSymTab$f")) const struct finsh_syscall __fsym_##cmd = {__fsym_##cmd##_name, FINSH_SYSCALL_FUNC(name) FINSH_SYSCALL_ARGS(args)};
 #pragma comment(linker, "/merge:FSymTab=mytext")
 
 #elif defined(__TI_COMPILER_VERSION__)
-#define MSH_FUNCTION_EXPORT_CMD(name, cmd, desc) \
-    __TI_FINSH_EXPORT_FUNCTION(__fsym_##cmd);    \
-    const char __fsym_##cmd##_name[] = #cmd;     \
-    const struct finsh_syscall __fsym_##cmd = {__fsym_##cmd##_name, (syscall_func) & name};
+#define MSH_FUNCTION_EXPORT_CMD_EX(name, cmd, desc, args) \
+    __TI_FINSH_EXPORT_FUNCTION(__fsym_##cmd);             \
+    const char __fsym_##cmd##_name[] = #cmd;              \
+    const struct finsh_syscall __fsym_##cmd = {__fsym_##cmd##_name, FINSH_SYSCALL_FUNC(name) FINSH_SYSCALL_ARGS(args)};
 
 #else
-#define MSH_FUNCTION_EXPORT_CMD(name, cmd, desc) \
-    const char __fsym_##cmd##_name[] = #cmd;     \
-    FINSH_USED const struct finsh_syscall __fsym_##cmd FINSH_SECTION("FSymTab") = {__fsym_##cmd##_name, (syscall_func) & name};
+#define MSH_FUNCTION_EXPORT_CMD_EX(name, cmd, desc, args) \
+    const char __fsym_##cmd##_name[] = #cmd;              \
+    FINSH_USED const struct finsh_syscall __fsym_##cmd FINSH_SECTION("FSymTab") = {__fsym_##cmd##_name, FINSH_SYSCALL_FUNC(name) FINSH_SYSCALL_ARGS(args)};
 
 #endif
 #endif /* end of FINSH_USING_DESCRIPTION */
 
+#define MSH_FUNCTION_EXPORT_CMD(name, cmd, desc) MSH_FUNCTION_EXPORT_CMD_EX(name, cmd, desc, 0)
+
 /**
  * @ingroup finsh
  *
@@ -149,6 +219,9 @@ struct finsh_syscall {
     const char *desc; /* description of system call */
 #endif
     syscall_func func; /* the function address of system call */
+#if defined(FINSH_USING_ARGS)
+    const struct msh_cmd_args *args; /* typed argument schema, NULL for plain commands */
+#endif
 };
 
 /* system call item */
@@ -159,6 +232,7 @@ struct finsh_syscall_item {
 
 extern struct finsh_syscall_item *global_syscall_list;
 extern struct finsh_syscall *_syscall_table_begin, *_syscall_table_end;
+extern uint8_t _syscall_table_sorted;
 
 #if defined(_MSC_VER) || (defined(__GNUC__) && defined(__x86_64__))
 struct finsh_syscall *finsh_syscall_next(struct finsh_syscall *call);
@@ -167,6 +241,10 @@ struct finsh_syscall *finsh_syscall_next(struct finsh_syscall *call);
 #define FINSH_NEXT_SYSCALL(index) index++
 #endif
 
+/* use a command table other than the FSymTab section */
+void finsh_system_function_init(const void *begin, const void *end);
+void finsh_system_function_init_sorted(const struct finsh_syscall *begin, const struct finsh_syscall *end);
+
 /* find out system call, which should be implemented in user program */
 struct finsh_syscall *finsh_syscall_lookup(const char *name);
 
@@ -178,8 +256,45 @@ typedef struct _finsh_shell_cfg {
     uint8_t echo_mode;
     uint8_t prompt_mode;
     int (*get_char)(void);
+    uint32_t (*get_tick)(void); /* optional monotonic tick source, FINSH_TICK_PER_SECOND */
+    void (*output)(const char *buf, uint32_t size); /* optional, stdout when NULL */
+    uint32_t (*get_clock)(void); /* optional high resolution clock, e.g. a cycle counter, for timings */
+    uint32_t clock_hz;           /* the rate of get_clock */
+
+    /*
+     * The memory of all shell state, see FINSH_ARENA_BYTES. When NULL a
+     * static arena sized by FINSH_CMD_SIZE, FINSH_HISTORY_LINES,
+     * FINSH_ARG_MAX, FINSH_EXEC_DEPTH and FINSH_CONSOLEBUF_SIZE is used,
+     * unless FINSH_USING_ARENA is defined. The sizes below are 0 for these
+     * macros.
+     */
+    void *arena;
+    uint32_t arena_size;
+    uint16_t line_size;     /* the longest command line */
+    uint16_t history_lines; /* the depth of the history */
+    uint8_t arg_max;        /* the most arguments of a command */
+    uint16_t prompt_size;   /* the longest prompt, with the terminating NUL */
+    uint8_t exec_depth;     /* the most msh_exec() running at once, commands running commands */
 } finsh_shell_cfg_t;
 int finsh_system_init(finsh_shell_cfg_t *cfg);
 void finsh_run(void);
 
+/* the bytes of the arena taken by each part of the shell state */
+struct finsh_footprint {
+    uint32_t shell;   /* the shell structure, with the completion cache and the typeahead */
+    uint32_t line;
+    uint32_t history;
+    uint32_t prompt;
+    uint32_t scratch; /* the copy of the line for the completion and bench */
+    uint32_t lines;   /* the copies of the lines of the shm client and the async commands */
+    uint32_t argv;
+    uint32_t used;    /* all of the above, aligned */
+    uint32_t size;    /* the size of the arena */
+};
+int finsh_footprint(struct finsh_footprint *footprint);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the C++ wrapper
+ */
+
+#ifndef __FINSH_HPP__
+#define __FINSH_HPP__
+
+/*
+ * A header-only C++14 wrapper of the shell:
+ *
+ *     static constexpr auto table = finsh::make_table({
+ *         {"reboot", "Reboot the board.", reboot},
+ *         {"led", "Switch the led.", led},
+ *     });
+ *
+ *     finsh::Shell shell(cfg);
+ *     shell.use(table);
+ *     shell.add("count", "Count the calls.", [&](int argc, char **argv) { return ++calls; });
+ *     shell.run();
+ *
+ * The table is sorted by name at compile time, a duplicate name does not
+ * compile, and the shell then finds its commands by binary search. The
+ * commands of the table are plain functions, in C++17 also lambdas without
+ * captures. Capturing lambdas are registered at run time and need
+ * FINSH_USING_REGISTRY.
+ *
+ * Shell owns its arena when cfg.arena is NULL. Its destructor unregisters
+ * its commands and makes the shell which was current before it current
+ * again.
+ *
+ * FINSH_CHECKED_PRINTF(fmt, ...) is finsh_printf() with the format checked
+ * against the arguments at compile time, by the rules of the formatter of
+ * the shell, with any compiler.
+ */
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "msh.h"
+#include "shell.h"
+
+namespace finsh {
+
+/* a command of a table built by make_table() */
+struct Entry {
+    const char *name;
+    const char *desc;
+    int (*func)(int argc, char **argv);
+};
+
+/*
+ * The commands sorted by name, and the finsh_syscall array the shell
+ * searches. A function pointer cast is not a constant expression, so the
+ * array is filled in place by Shell::use(), the table is its storage.
+ */
+template <std::size_t N>
+struct Table {
+    Entry entries[N];
+    mutable finsh_syscall calls[N];
+
+    constexpr std::size_t size() const { return N; }
+    constexpr const Entry &operator[](std::size_t index) const { return entries[index]; }
+};
+
+namespace detail {
+
+/* the order of strcmp(), which the shell uses to search the table */
+constexpr int compare(const char *a, const char *b) {
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+
+    return (unsigned char)*a - (unsigned char)*b;
+}
+
+/* not constexpr, so a table with a duplicate name fails to compile */
+inline void duplicate_command_name() {}
+
+} // namespace detail
+
+/**
+ * This function sorts a table of commands by name, at compile time when
+ * the result is constexpr.
+ */
+template <std::size_t N>
+constexpr Table<N> make_table(const Entry (&entries)[N]) {
+    Table<N> table{};
+
+    for (std::size_t i = 0; i < N; i++) {
+        Entry entry = entries[i];
+        std::size_t j = i;
+
+        for (; j > 0 && detail::compare(table.entries[j - 1].name, entry.name) > 0; j--)
+            table.entries[j] = table.entries[j - 1];
+        if (j > 0 && detail::compare(table.entries[j - 1].name, entry.name) == 0) detail::duplicate_command_name();
+        table.entries[j] = entry;
+    }
+
+    return table;
+}
+
+namespace detail {
+
+/* what a conversion of finsh_printf() takes from the arguments */
+enum class Arg { none, integer, long_integer, long_long_integer, pointer, string, floating, other };
+
+template <typename T>
+constexpr Arg arg_of() {
+    return std::is_same<T, char *>::value || std::is_same<T, const char *>::value ? Arg::string
+           : std::is_pointer<T>::value || std::is_same<T, std::nullptr_t>::value ? Arg::pointer
+           : std::is_same<T, long>::value || std::is_same<T, unsigned long>::value ? Arg::long_integer
+           : std::is_same<T, long long>::value || std::is_same<T, unsigned long long>::value ? Arg::long_long_integer
+           : (std::is_integral<T>::value || std::is_enum<T>::value) && sizeof(T) <= sizeof(int) ? Arg::integer
+           : std::is_floating_point<T>::value ? Arg::floating
+           : Arg::other;
+}
+
+template <typename... T>
+struct Types {};
+
+/* the types of the arguments as they are passed to a variadic function, never called */
+template <typename... T>
+Types<T...> types(T...);
+
+/* true when fmt, of the subset of shell.c, takes exactly the arguments T */
+template <typename... T>
+constexpr bool check_format(const char *fmt, Types<T...>) {
+    const Arg args[] = {arg_of<T>()..., Arg::none};
+    std::size_t count = 0;
+
+    while (*fmt) {
+        Arg want = Arg::integer;
+
+        if (*fmt++ != '%') continue;
+        if (*fmt == '%') {
+            fmt++;
+            continue;
+        }
+
+        while (*fmt == '-' || *fmt == '0') fmt++;
+        if (*fmt == '*') {
+            if (count >= sizeof...(T) || args[count++] != Arg::integer) return false;
+            fmt++;
+        }
+        while (*fmt >= '0' && *fmt <= '9') fmt++;
+        if (*fmt == '.') {
+            fmt++;
+            if (*fmt == '*') {
+                if (count >= sizeof...(T) || args[count++] != Arg::integer) return false;
+                fmt++;
+            }
+            while (*fmt >= '0' && *fmt <= '9') fmt++;
+        }
+
+        if (*fmt == 'l') {
+            want = *++fmt == 'l' ? (fmt++, Arg::long_long_integer) : Arg::long_integer;
+        } else if (*fmt == 'z') {
+            want = arg_of<std::size_t>();
+            fmt++;
+        } else if (*fmt == 'h') {
+            fmt++;
+        }
+
+        switch (*fmt++) {
+            case 'c':
+                want = Arg::integer;
+                break;
+            case 's':
+                want = Arg::string;
+                break;
+            case 'p':
+                want = Arg::pointer;
+                break;
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                break;
+#ifdef FINSH_USING_LIBC_PRINTF
+            case 'f':
+            case 'e':
+            case 'g':
+                want = Arg::floating;
+                break;
+#endif
+            default:
+                return false;
+        }
+
+        if (count >= sizeof...(T)) return false;
+        if (args[count] != want && !(want == Arg::pointer && args[count] == Arg::string)) return false;
+        count++;
+    }
+
+    return count == sizeof...(T);
+}
+
+/* the same with the type of the format first, as FINSH_CHECKED_PRINTF passes them */
+template <typename F, typename... T>
+constexpr bool check_call(const char *fmt, Types<F, T...>) {
+    return check_format(fmt, Types<T...>());
+}
+
+template <bool Matches>
+struct CheckedFormat {
+    static_assert(Matches, "the arguments do not match the format");
+};
+
+} // namespace detail
+
+#define FINSH_FORMAT_OF(fmt, ...) fmt
+#define FINSH_CHECKED_PRINTF(...)                                                                                    \
+    ((void)finsh::detail::CheckedFormat<finsh::detail::check_call(FINSH_FORMAT_OF(__VA_ARGS__, ~),                   \
+                                                                  decltype(finsh::detail::types(__VA_ARGS__))())>(), \
+     finsh_printf(__VA_ARGS__))
+
+#ifdef FINSH_USING_REGISTRY
+class CommandBase {
+  public:
+    virtual ~CommandBase() {}
+};
+
+/*
+ * A command registered while the object lives. func is any callable taking
+ * (int argc, char **argv) and returning int, e.g. a capturing lambda.
+ */
+template <typename F>
+class Command : public CommandBase {
+  public:
+    Command(const char *name, const char *desc, F func) : func_(std::move(func)) {
+        cmd_.name = name;
+        cmd_.desc = desc;
+        cmd_.func = call;
+        cmd_.ctx = this;
+        registered_ = msh_cmd_register(&cmd_) == 0;
+    }
+    ~Command() override {
+        if (registered_) msh_cmd_unregister(&cmd_);
+    }
+    Command(const Command &) = delete;
+    Command &operator=(const Command &) = delete;
+
+    /* false when the name is taken or the registry is full */
+    bool registered() const { return registered_; }
+
+  private:
+    static int call(void *ctx, int argc, char **argv) { return static_cast<Command *>(ctx)->func_(argc, argv); }
+
+    F func_;
+    struct msh_cmd cmd_ = {};
+    bool registered_;
+};
+
+template <typename F>
+std::unique_ptr<Command<F>> make_command(const char *name, const char *desc, F func) {
+    return std::unique_ptr<Command<F>>(new Command<F>(name, desc, std::move(func)));
+}
+#endif /* FINSH_USING_REGISTRY */
+
+class Shell {
+  public:
+    explicit Shell(finsh_shell_cfg_t cfg) : cfg_(cfg), previous_(finsh_shell_current) {
+        if (cfg_.arena == nullptr) {
+            cfg_.arena_size = FINSH_ARENA_BYTES(cfg_.line_size ? cfg_.line_size : FINSH_CMD_SIZE,
+                                                cfg_.history_lines ? cfg_.history_lines : FINSH_HISTORY_LINES,
+                                                cfg_.arg_max ? cfg_.arg_max : FINSH_ARG_MAX,
+                                                cfg_.exec_depth ? cfg_.exec_depth : FINSH_EXEC_DEPTH,
+                                                cfg_.prompt_size ? cfg_.prompt_size : FINSH_CONSOLEBUF_SIZE + 1);
+            arena_.reset(new unsigned char[cfg_.arena_size]);
+            cfg_.arena = arena_.get();
+        }
+        ready_ = finsh_system_init(&cfg_) == 0;
+    }
+    ~Shell() {
+#ifdef FINSH_USING_REGISTRY
+        commands_.clear();
+#endif
+        if (table_used_) {
+            finsh_system_function_init(previous_begin_, previous_end_);
+            _syscall_table_sorted = previous_sorted_;
+        }
+        finsh_shell_current = previous_;
+    }
+    Shell(const Shell &) = delete;
+    Shell &operator=(const Shell &) = delete;
+
+    /* false when the arena given in cfg is too small */
+    bool ready() const { return ready_; }
+
+    /* use table as the command table instead of the FSymTab section */
+    template <std::size_t N>
+    void use(const Table<N> &table) {
+        if (!table_used_) {
+            previous_begin_ = _syscall_table_begin;
+            previous_end_ = _syscall_table_end;
+            previous_sorted_ = _syscall_table_sorted;
+        }
+        table_used_ = true;
+        for (std::size_t i = 0; i < N; i++) {
+            table.calls[i].name = table[i].name;
+#ifdef FINSH_USING_DESCRIPTION
+            table.calls[i].desc = table[i].desc;
+#endif
+            table.calls[i].func = FINSH_SYSCALL_FUNC(table[i].func);
+        }
+        finsh_system_function_init_sorted(table.calls, table.calls + N);
+    }
+
+#ifdef FINSH_USING_REGISTRY
+    /* register func until the shell is destroyed, false when the name is taken */
+    template <typename F>
+    bool add(const char *name, const char *desc, F func) {
+        auto command = make_command(name, desc, std::move(func));
+
+        if (!command->registered()) return false;
+        commands_.emplace_back(std::move(command));
+        return true;
+    }
+#endif
+
+    void run() { finsh_run(); }
+    int exec(const char *line) {
+        std::vector<char> copy(line, line + FINSH_STRLEN(line) + 1);
+
+        return msh_exec(copy.data(), (uint32_t)(copy.size() - 1));
+    }
+
+  private:
+    finsh_shell_cfg_t cfg_;
+    struct finsh_shell *previous_;
+    std::unique_ptr<unsigned char[]> arena_;
+    bool table_used_ = false; /* a table is in use, the previous one is saved */
+    struct finsh_syscall *previous_begin_ = nullptr, *previous_end_ = nullptr;
+    uint8_t previous_sorted_ = 0;
+#ifdef FINSH_USING_REGISTRY
+    std::vector<std::unique_ptr<CommandBase>> commands_;
+#endif
+    bool ready_;
+};
+
+} // namespace finsh
+
+#endif
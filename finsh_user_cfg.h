@@ -4,5 +4,24 @@
 #define FINSH_USING_HISTORY
 // #define FINSH_USING_AUTH
 #define FINSH_USING_DESCRIPTION
+// #define FINSH_USING_CANCEL
+// #define FINSH_USING_ASYNC
+// #define FINSH_USING_RPC
+// #define FINSH_USING_SHM
+// #define FINSH_USING_EMIT
+// #define FINSH_USING_LIBC_PRINTF
+// #define FINSH_USING_ARGS
+// #define FINSH_USING_COMPLETE
+// #define FINSH_USING_REGISTRY
+// #define FINSH_NO_SYMTAB
+// #define FINSH_USING_STATS
+// #define FINSH_USING_TRACE
+// #define FINSH_USING_BENCH
+// #define FINSH_USING_REPLAY
+// #define FINSH_USING_EOF
+// #define FINSH_USING_LOG
+// #define FINSH_USING_BULK
+// #define FINSH_USING_PASTE
+// #define FINSH_USING_ARENA
 
 #endif // FINSH_USER_CFG
@@ -12,35 +12,204 @@
  */
 #include <string.h>
 
-#ifndef FINSH_ARG_MAX
-#define FINSH_ARG_MAX 8
-#endif /* FINSH_ARG_MAX */
-
 #include "msh.h"
+#include "msh_args.h"
+#include "msh_emit.h"
+#include "msh_stats.h"
+#include "msh_trace.h"
 #include "shell.h"
 
 typedef int (*cmd_function_t)(int argc, char **argv);
 
-int msh_help(int argc, char **argv) {
-    FINSH_PRINTF("Finsh shell commands:\r\n");
-    {
-        struct finsh_syscall *index;
+static struct finsh_syscall *msh_get_syscall(const char *cmd, int size) {
+    struct finsh_syscall *index;
 
-        for (index = _syscall_table_begin; index < _syscall_table_end; FINSH_NEXT_SYSCALL(index)) {
+    if (_syscall_table_sorted) {
+        struct finsh_syscall *low = _syscall_table_begin, *high = _syscall_table_end;
+
+        while (low < high) {
+            int result;
+
+            index = low + (high - low) / 2;
+            result = FINSH_STRNCMP(index->name, cmd, size);
+            if (result == 0 && index->name[size] != '\0') result = 1;
+            if (result == 0) return index;
+            if (result < 0)
+                low = index + 1;
+            else
+                high = index;
+        }
+
+        return NULL;
+    }
+
+    for (index = _syscall_table_begin; index < _syscall_table_end; FINSH_NEXT_SYSCALL(index)) {
+        if (FINSH_STRNCMP(index->name, cmd, size) == 0 && index->name[size] == '\0') return index;
+    }
+
+    return NULL;
+}
+
+/**
+ * @ingroup msh
+ *
+ * This function looks up a command the way the shell dispatches it.
+ *
+ * @return 0 on OK, -1 when there is no such command
+ */
+int msh_resolve(const char *name, struct msh_target *target) {
+    struct finsh_syscall *call;
+
+    FINSH_MEMSET(target, 0, sizeof(*target));
+#ifdef FINSH_USING_REGISTRY
+    target->reg = msh_cmd_find(name, FINSH_STRLEN(name));
+    if (target->reg) {
+        target->name = target->reg->name;
+        return 0;
+    }
+#endif
+
+    call = msh_get_syscall(name, FINSH_STRLEN(name));
+    if (call == NULL) return -1;
+
+    target->name = call->name;
+    target->func = (cmd_function_t)(void (*)(void))call->func;
+    return 0;
+}
+
+/**
+ * @ingroup msh
+ *
+ * This function runs a command found by msh_resolve().
+ */
+int msh_call(const struct msh_target *target, int argc, char **argv) {
+#ifdef FINSH_USING_REGISTRY
+    if (target->reg) return target->reg->func(target->reg->ctx, argc, argv);
+#endif
+
+    return target->func(argc, argv);
+}
+
+#ifdef FINSH_USING_ARGS
+/* the typed argument schema of a command, NULL for plain commands */
+static const struct msh_cmd_args *msh_get_args(const char *name) {
+    struct finsh_syscall *call;
+#ifdef FINSH_USING_REGISTRY
+    struct msh_cmd *cmd = msh_cmd_find(name, FINSH_STRLEN(name));
+
+    if (cmd) return cmd->args;
+#endif
+
+    call = msh_get_syscall(name, FINSH_STRLEN(name));
+    return call ? call->args : NULL;
+}
+#endif /* FINSH_USING_ARGS */
+
+static void msh_help_entry(const char *name, const char *desc) {
+#ifdef FINSH_USING_EMIT
+    finsh_emit_begin();
 #if defined(FINSH_USING_DESCRIPTION)
-            FINSH_PRINTF("%-16s - %s\r\n", index->name, index->desc);
+    finsh_emit_str("name", name, "%-16s");
+    finsh_emit_str("desc", desc, " - %s");
+    finsh_emit_end("\r\n");
+#else
+    finsh_emit_str("name", name, "%s ");
+    finsh_emit_end(NULL);
+#endif
+#elif defined(FINSH_USING_DESCRIPTION)
+    FINSH_PRINTF("%-16s - %s\r\n", name, desc);
 #else
-            FINSH_PRINTF("%s ", index->name);
+    FINSH_PRINTF("%s ", name);
+#endif
+    (void)desc;
+}
+
+int msh_help(int argc, char **argv) {
+    struct finsh_syscall *index;
+
+    (void)argc;
+    (void)argv;
+
+#ifdef FINSH_USING_ARGS
+    if (argc == 2) {
+        const struct msh_cmd_args *args = msh_get_args(argv[1]);
+#ifdef FINSH_USING_REGISTRY
+        struct msh_cmd *cmd = msh_cmd_find(argv[1], FINSH_STRLEN(argv[1]));
+#endif
+
+        index = msh_get_syscall(argv[1], FINSH_STRLEN(argv[1]));
+#ifdef FINSH_USING_REGISTRY
+        if (cmd) {
+            FINSH_PRINTF("%s - %s\r\n", cmd->name, cmd->desc ? cmd->desc : "");
+        } else
 #endif
+        if (index) {
+#if defined(FINSH_USING_DESCRIPTION)
+            FINSH_PRINTF("%s - %s\r\n", index->name, index->desc);
+#endif
+        } else {
+            FINSH_PRINTF("%s: command not found.\r\n", argv[1]);
+            return -1;
         }
+
+        if (args) msh_args_usage(argv[1], args);
+        return 0;
+    }
+#endif /* FINSH_USING_ARGS */
+
+#ifdef FINSH_USING_EMIT
+    finsh_emit_text("Finsh shell commands:\r\n");
+#else
+    FINSH_PUTS("Finsh shell commands:\r\n");
+#endif
+
+    for (index = _syscall_table_begin; index < _syscall_table_end; FINSH_NEXT_SYSCALL(index)) {
+#if defined(FINSH_USING_DESCRIPTION)
+        msh_help_entry(index->name, index->desc);
+#else
+        msh_help_entry(index->name, NULL);
+#endif
+    }
+#ifdef FINSH_USING_REGISTRY
+    {
+        int i;
+
+        for (i = 0; i < msh_cmd_count(); i++) msh_help_entry(msh_cmd_at(i)->name, msh_cmd_at(i)->desc);
     }
-    FINSH_PRINTF("\r\n");
+#endif
+
+#ifdef FINSH_USING_EMIT
+    finsh_emit_text("\r\n");
+#else
+    FINSH_PUTS("\r\n");
+#endif
 
     return 0;
 }
 MSH_CMD_EXPORT_ALIAS(msh_help, help, Finsh shell help.);
 
-static int msh_split(char *cmd, uint32_t length, char *argv[FINSH_ARG_MAX]) {
+static int msh_footprint(int argc, char **argv) {
+    struct finsh_footprint footprint;
+
+    (void)argc;
+    (void)argv;
+
+    if (finsh_footprint(&footprint) != 0) return -1;
+
+    FINSH_PRINTF("shell   %u\r\n", (unsigned int)footprint.shell);
+    FINSH_PRINTF("line    %u\r\n", (unsigned int)footprint.line);
+    FINSH_PRINTF("history %u\r\n", (unsigned int)footprint.history);
+    FINSH_PRINTF("prompt  %u\r\n", (unsigned int)footprint.prompt);
+    FINSH_PRINTF("scratch %u\r\n", (unsigned int)footprint.scratch);
+    FINSH_PRINTF("lines   %u\r\n", (unsigned int)footprint.lines);
+    FINSH_PRINTF("argv    %u\r\n", (unsigned int)footprint.argv);
+    FINSH_PRINTF("used    %u of %u\r\n", (unsigned int)footprint.used, (unsigned int)footprint.size);
+
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(msh_footprint, footprint, Show the memory used by the shell.);
+
+static int msh_split(char *cmd, uint32_t length, char *argv[], uint32_t max) {
     char *ptr;
     uint32_t position;
     uint32_t argc;
@@ -58,12 +227,12 @@ static int msh_split(char *cmd, uint32_t length, char *argv[FINSH_ARG_MAX]) {
             position++;
         }
 
-        if (argc >= FINSH_ARG_MAX) {
-            FINSH_PRINTF("Too many args ! We only Use:\r\n");
+        if (argc >= max) {
+            FINSH_PUTS("Too many args ! We only Use:\r\n");
             for (i = 0; i < argc; i++) {
                 FINSH_PRINTF("%s ", argv[i]);
             }
-            FINSH_PRINTF("\r\n");
+            FINSH_PUTS("\r\n");
             break;
         }
 
@@ -107,25 +276,21 @@ static int msh_split(char *cmd, uint32_t length, char *argv[FINSH_ARG_MAX]) {
     return argc;
 }
 
-static cmd_function_t msh_get_cmd(char *cmd, int size) {
-    struct finsh_syscall *index;
-    cmd_function_t cmd_func = NULL;
-
-    for (index = _syscall_table_begin; index < _syscall_table_end; FINSH_NEXT_SYSCALL(index)) {
-        if (FINSH_STRNCMP(index->name, cmd, size) == 0 && index->name[size] == '\0') {
-            cmd_func = (cmd_function_t)index->func;
-            break;
-        }
-    }
-
-    return cmd_func;
-}
-
 static int _msh_exec_cmd(char *cmd, uint32_t length, int *retp) {
     int argc;
     uint32_t cmd0_size = 0;
-    cmd_function_t cmd_func;
-    char *argv[FINSH_ARG_MAX];
+    struct finsh_syscall *call = NULL;
+    char **argv;
+    uint32_t max;
+#ifdef FINSH_USING_REGISTRY
+    struct msh_cmd *reg;
+#endif
+#if defined(FINSH_USING_STATS) || defined(FINSH_USING_TRACE)
+    const char *name;
+#endif
+#ifdef FINSH_USING_STATS
+    uint32_t start;
+#endif
 
     if (cmd == NULL || retp == NULL) return -1;
 
@@ -133,21 +298,62 @@ static int _msh_exec_cmd(char *cmd, uint32_t length, int *retp) {
     while ((cmd[cmd0_size] != ' ' && cmd[cmd0_size] != '\t') && cmd0_size < length) cmd0_size++;
     if (cmd0_size == 0) return -1;
 
-    cmd_func = msh_get_cmd(cmd, cmd0_size);
-    if (cmd_func == NULL) return -1;
+    FINSH_TRACE_BEGIN("lookup");
+#ifdef FINSH_USING_REGISTRY
+    /* registered commands come first and may override the table */
+    reg = msh_cmd_find(cmd, cmd0_size);
+    if (reg == NULL) call = msh_get_syscall(cmd, cmd0_size);
+    FINSH_TRACE_END("lookup");
+    if (reg == NULL && call == NULL) return -1;
+#else
+    call = msh_get_syscall(cmd, cmd0_size);
+    FINSH_TRACE_END("lookup");
+    if (call == NULL) return -1;
+#endif
 
-    /* split arguments */
-    FINSH_MEMSET(argv, 0x00, sizeof(argv));
-    argc = msh_split(cmd, length, argv);
+    /* split arguments into the argv slots of this level of msh_exec() */
+    if (finsh_shell_current->exec_depth > finsh_shell_current->exec_depth_max) {
+        FINSH_PUTS("Too many nested commands !\r\n");
+        return -1;
+    }
+    max = finsh_shell_current->arg_max;
+    argv = &finsh_shell_current->argv[(finsh_shell_current->exec_depth - 1) * max];
+    FINSH_TRACE_BEGIN("split");
+    FINSH_MEMSET(argv, 0x00, max * sizeof(char *));
+    argc = msh_split(cmd, length, argv, max);
+    FINSH_TRACE_END("split");
     if (argc == 0) return -1;
 
+#if defined(FINSH_USING_STATS) || defined(FINSH_USING_TRACE)
+    /* the table keeps the name, so it is a stable key for the counters */
+#ifdef FINSH_USING_REGISTRY
+    name = reg ? reg->name : call->name;
+#else
+    name = call->name;
+#endif
+#endif
+#ifdef FINSH_USING_STATS
+    start = finsh_get_clock();
+#endif
+
     /* exec this command */
-    *retp = cmd_func(argc, argv);
+    FINSH_TRACE_BEGIN(name);
+#ifdef FINSH_USING_REGISTRY
+    if (reg)
+        *retp = reg->func(reg->ctx, argc, argv);
+    else
+#endif
+        *retp = ((cmd_function_t)(void (*)(void))call->func)(argc, argv);
+    FINSH_TRACE_END(name);
+
+#ifdef FINSH_USING_STATS
+    msh_stats_record(name, finsh_get_clock() - start, *retp);
+#endif
     return 0;
 }
 
 int msh_exec(char *cmd, uint32_t length) {
-    int cmd_ret;
+    int cmd_ret, ret;
 
     /* strim the beginning of command */
     while ((length > 0) && (*cmd == ' ' || *cmd == '\t')) {
@@ -157,11 +363,26 @@ int msh_exec(char *cmd, uint32_t length) {
 
     if (length == 0) return 0;
 
+#ifdef FINSH_USING_CANCEL
+    /* a command run by another one keeps its deadline and a pending ctrl-c */
+    if (finsh_shell_current->exec_depth == 0) finsh_cancel_reset();
+#endif
+
     /* Exec sequence:
      * 1. built-in command
      * 2. module(if enabled)
      */
-    if (_msh_exec_cmd(cmd, length, &cmd_ret) == 0) {
+    finsh_shell_current->exec_depth++;
+    ret = _msh_exec_cmd(cmd, length, &cmd_ret);
+    finsh_shell_current->exec_depth--;
+    if (ret == 0) {
+#ifdef FINSH_USING_CANCEL
+        if (finsh_shell_current->exec_depth == 0 && finsh_cancel_reset() == FINSH_CANCEL_INTR) FINSH_PUTS("^C\r\n");
+#endif
+#ifdef FINSH_USING_COMPLETE
+        /* the command may have changed what the completers list */
+        msh_complete_invalidate();
+#endif
         return cmd_ret;
     }
 
@@ -178,6 +399,84 @@ int msh_exec(char *cmd, uint32_t length) {
     return -1;
 }
 
+#ifdef FINSH_USING_CANCEL
+/* parse "500ms", "2s" or "1m" into ticks, a bare number is in seconds */
+static int msh_parse_duration(const char *str, uint32_t *ticks) {
+    uint64_t value = 0;
+    uint32_t unit_ms = 1000;
+
+    if (*str < '0' || *str > '9') return -1;
+    while (*str >= '0' && *str <= '9') {
+        value = value * 10 + (*str - '0');
+        if (value > 0xFFFFFFFFUL) return -1;
+        str++;
+    }
+
+    if (FINSH_STRNCMP(str, "ms", 3) == 0)
+        unit_ms = 1;
+    else if (*str == '\0' || FINSH_STRNCMP(str, "s", 2) == 0)
+        unit_ms = 1000;
+    else if (FINSH_STRNCMP(str, "m", 2) == 0)
+        unit_ms = 60 * 1000;
+    else
+        return -1;
+
+    /* the deadline is compared as a signed tick difference */
+    if (value > 0x7FFFFFFFULL * 1000 / ((uint64_t)unit_ms * FINSH_TICK_PER_SECOND)) return -1;
+    value = value * unit_ms * FINSH_TICK_PER_SECOND / 1000;
+    *ticks = (uint32_t)value;
+
+    return 0;
+}
+
+int msh_timeout(int argc, char **argv) {
+    struct msh_target target;
+    uint32_t ticks, deadline;
+    uint8_t armed, cancel;
+    int ret, timed_out;
+
+    if (argc < 3) {
+        FINSH_PUTS("Usage: timeout <duration[ms|s|m]> <command> [args...]\r\n");
+        return -1;
+    }
+
+    if (msh_parse_duration(argv[1], &ticks) != 0) {
+        FINSH_PRINTF("timeout: invalid duration '%s'\r\n", argv[1]);
+        return -1;
+    }
+
+    if (msh_resolve(argv[2], &target) != 0) {
+        FINSH_PRINTF("%s: command not found.\r\n", argv[2]);
+        return -1;
+    }
+
+    /* the deadline covers this command only, e.g. when bench or another timeout runs it */
+    deadline = finsh_shell_current->deadline;
+    armed = finsh_shell_current->deadline_armed;
+    cancel = finsh_shell_current->cancel;
+
+    if (finsh_set_deadline(ticks) != 0) {
+        FINSH_PUTS("timeout: no tick source\r\n");
+        return -1;
+    }
+
+    ret = msh_call(&target, argc - 2, &argv[2]);
+    timed_out = finsh_cancelled() == FINSH_CANCEL_TIMEOUT;
+
+    /* a ctrl-c is kept for the caller, an expired outer deadline fires again */
+    finsh_shell_current->deadline = deadline;
+    finsh_shell_current->deadline_armed = armed;
+    if (timed_out) {
+        finsh_shell_current->cancel = cancel;
+        FINSH_PRINTF("%s: timed out\r\n", argv[2]);
+        return -1;
+    }
+
+    return ret;
+}
+MSH_CMD_EXPORT_ALIAS(msh_timeout, timeout, Run a command with a time limit.);
+#endif /* FINSH_USING_CANCEL */
+
 static int str_common(const char *str1, const char *str2) {
     const char *str = str1;
 
@@ -189,8 +488,212 @@ static int str_common(const char *str1, const char *str2) {
     return (str - str1);
 }
 
+#if defined(FINSH_USING_ARGS) || defined(FINSH_USING_COMPLETE)
+struct msh_complete {
+    const char *word; /* the word being completed */
+    uint32_t length;
+    int count;                      /* the number of matching candidates */
+    int min_length; /* the common length of all matching candidates */
+    char *match;    /* the first matching candidate, line_size + 1 bytes */
+};
+
+static void msh_complete_candidate(const char *str, void *arg) {
+    struct msh_complete *complete = (struct msh_complete *)arg;
+    int length;
+
+    if (FINSH_STRNCMP(complete->word, str, complete->length) != 0) return;
+
+    /* keep a copy, the candidate may live in a buffer of the completer */
+    if (complete->count++ == 0) {
+        FINSH_STRNCPY(complete->match, str, finsh_shell_current->line_size);
+        complete->match[finsh_shell_current->line_size] = '\0';
+        complete->min_length = FINSH_STRLEN(complete->match);
+    }
+    length = str_common(complete->match, str);
+    if (length < complete->min_length) complete->min_length = length;
+
+    FINSH_PRINTF("%s\r\n", str);
+}
+
+#ifdef FINSH_USING_COMPLETE
+static struct {
+    const char *name;
+    msh_completer_t completer;
+} msh_completers[FINSH_COMPLETE_MAX];
+
+/**
+ * @ingroup msh
+ *
+ * This function registers the argument completer of a command, replacing
+ * the previous one. A NULL completer removes it.
+ *
+ * @return 0 on OK, -1 when the completer table is full
+ */
+int msh_complete_register(const char *name, msh_completer_t completer) {
+    int index, slot = -1;
+
+    for (index = 0; index < FINSH_COMPLETE_MAX; index++) {
+        if (msh_completers[index].name && FINSH_STRNCMP(msh_completers[index].name, name, FINSH_STRLEN(name) + 1) == 0) {
+            slot = index;
+            break;
+        }
+        if (slot < 0 && msh_completers[index].name == NULL) slot = index;
+    }
+    if (slot < 0) return completer ? -1 : 0;
+
+    msh_completers[slot].name = completer ? name : NULL;
+    msh_completers[slot].completer = completer;
+    msh_complete_invalidate();
+
+    return 0;
+}
+
+/**
+ * @ingroup msh
+ *
+ * This function drops the cached candidates, call it when the source of a
+ * completer changes, e.g. a device is attached.
+ */
+void msh_complete_invalidate(void) {
+    if (finsh_shell_current) finsh_shell_current->complete_key = 0;
+}
+
+static msh_completer_t msh_get_completer(const char *name) {
+    int index;
+
+    for (index = 0; index < FINSH_COMPLETE_MAX; index++) {
+        if (msh_completers[index].name && FINSH_STRNCMP(msh_completers[index].name, name, FINSH_STRLEN(name) + 1) == 0)
+            return msh_completers[index].completer;
+    }
+
+    return NULL;
+}
+
+struct msh_complete_fill {
+    struct msh_complete *complete;
+    uint8_t overflow; /* the candidates do not fit in the cache */
+};
+
+/* copies each candidate to the session cache while matching it */
+static void msh_complete_cache(const char *str, void *arg) {
+    struct msh_complete_fill *fill = (struct msh_complete_fill *)arg;
+    uint32_t size = FINSH_STRLEN(str) + 1;
+
+    if (finsh_shell_current->complete_size + size <= FINSH_COMPLETE_CACHE_SIZE) {
+        FINSH_MEMCPY(&finsh_shell_current->complete_cache[finsh_shell_current->complete_size], str, size);
+        finsh_shell_current->complete_size += size;
+    } else {
+        fill->overflow = 1;
+    }
+
+    msh_complete_candidate(str, fill->complete);
+}
+
+/* FNV-1a of the line before the word, never 0 */
+static uint32_t msh_complete_key(const char *str, uint32_t size) {
+    uint32_t hash = 2166136261UL;
+
+    while (size--) hash = (hash ^ (uint8_t)*str++) * 16777619UL;
+
+    return hash ? hash : 1;
+}
+#endif /* FINSH_USING_COMPLETE */
+
+/* complete the argument of a command, 0 when it has no completion source */
+static int msh_complete_args(char *prefix) {
+    /* the line is copied to be split, the arena has room for it and the match */
+    char *line = finsh_shell_current->scratch;
+    char **argv = finsh_shell_current->scratch_argv;
+    const struct msh_cmd_args *args = NULL;
+    struct msh_complete complete;
+    uint32_t offset;
+    int argc;
+#ifdef FINSH_USING_COMPLETE
+    msh_completer_t completer;
+    uint32_t key;
+#endif
+
+    /* the word being completed starts after the last blank */
+    offset = FINSH_STRLEN(prefix);
+    while (offset > 0 && prefix[offset - 1] != ' ' && prefix[offset - 1] != '\t') offset--;
+    if (offset == 0 || offset > finsh_shell_current->line_size) return 0;
+
+    FINSH_MEMCPY(line, prefix, offset);
+    line[offset] = '\0';
+    FINSH_MEMSET(argv, 0x00, (finsh_shell_current->arg_max + 1) * sizeof(char *));
+    argc = msh_split(line, offset, argv, finsh_shell_current->arg_max);
+    if (argc == 0) return 0;
+
+#ifdef FINSH_USING_ARGS
+    args = msh_get_args(argv[0]);
+#endif
+#ifdef FINSH_USING_COMPLETE
+    completer = msh_get_completer(argv[0]);
+    if (args == NULL && completer == NULL) return 0;
+#else
+    if (args == NULL) return 0;
+#endif
+
+    FINSH_MEMSET(&complete, 0x00, sizeof(complete));
+    complete.match = &finsh_shell_current->scratch[finsh_shell_current->line_size + 1];
+    complete.word = &prefix[offset];
+    complete.length = FINSH_STRLEN(complete.word);
+
+#ifdef FINSH_USING_COMPLETE
+    /* repeated tabs on the same argument reuse the candidates */
+    key = msh_complete_key(prefix, offset);
+    if (finsh_shell_current->complete_key == key) {
+        const char *str;
+
+        for (str = finsh_shell_current->complete_cache;
+             str < &finsh_shell_current->complete_cache[finsh_shell_current->complete_size]; str += FINSH_STRLEN(str) + 1)
+            msh_complete_candidate(str, &complete);
+    } else {
+        struct msh_complete_fill fill = {&complete, 0};
+
+        finsh_shell_current->complete_key = 0;
+        finsh_shell_current->complete_size = 0;
+        if (completer) completer(argc, argv, msh_complete_cache, &fill);
+#ifdef FINSH_USING_ARGS
+        if (args) msh_args_complete(args, argc, argv, msh_complete_cache, &fill);
+#endif
+        if (!fill.overflow) finsh_shell_current->complete_key = key;
+    }
+#elif defined(FINSH_USING_ARGS)
+    msh_args_complete(args, argc, argv, msh_complete_candidate, &complete);
+#endif
+
+    if (complete.count) {
+        if (complete.min_length > (int)(finsh_shell_current->line_size - offset))
+            complete.min_length = finsh_shell_current->line_size - offset;
+        FINSH_STRNCPY(&prefix[offset], complete.match, complete.min_length);
+        prefix[offset + complete.min_length] = '\0';
+    }
+
+    return 1;
+}
+#endif /* FINSH_USING_ARGS || FINSH_USING_COMPLETE */
+
+static void msh_complete_name(const char *prefix, const char *cmd_name, const char **name_ptr, int *min_length) {
+    int length;
+
+    if (FINSH_STRNCMP(prefix, cmd_name, FINSH_STRLEN(prefix)) != 0) return;
+
+    if (*min_length == 0) {
+        /* set name_ptr */
+        *name_ptr = cmd_name;
+        /* set initial length */
+        *min_length = FINSH_STRLEN(cmd_name);
+    }
+
+    length = str_common(*name_ptr, cmd_name);
+    if (length < *min_length) *min_length = length;
+
+    FINSH_PRINTF("%s\r\n", cmd_name);
+}
+
 void msh_auto_complete(char *prefix) {
-    int length, min_length;
+    int min_length;
     const char *name_ptr, *cmd_name;
     struct finsh_syscall *index;
 
@@ -202,29 +705,31 @@ void msh_auto_complete(char *prefix) {
         return;
     }
 
+#if defined(FINSH_USING_ARGS) || defined(FINSH_USING_COMPLETE)
+    if (msh_complete_args(prefix)) return;
+#endif
+
     /* checks in internal command */
     {
         for (index = _syscall_table_begin; index < _syscall_table_end; FINSH_NEXT_SYSCALL(index)) {
             /* skip finsh shell function */
             cmd_name = (const char *)index->name;
-            if (FINSH_STRNCMP(prefix, cmd_name, FINSH_STRLEN(prefix)) == 0) {
-                if (min_length == 0) {
-                    /* set name_ptr */
-                    name_ptr = cmd_name;
-                    /* set initial length */
-                    min_length = FINSH_STRLEN(name_ptr);
-                }
+            msh_complete_name(prefix, cmd_name, &name_ptr, &min_length);
+        }
+    }
 
-                length = str_common(name_ptr, cmd_name);
-                if (length < min_length) min_length = length;
+#ifdef FINSH_USING_REGISTRY
+    /* checks in registered command */
+    {
+        int i;
 
-                FINSH_PRINTF("%s\r\n", cmd_name);
-            }
-        }
+        for (i = 0; i < msh_cmd_count(); i++) msh_complete_name(prefix, msh_cmd_at(i)->name, &name_ptr, &min_length);
     }
+#endif
 
     /* auto complete string */
     if (name_ptr != NULL) {
+        if (min_length > finsh_shell_current->line_size) min_length = finsh_shell_current->line_size;
         FINSH_STRNCPY(prefix, name_ptr, min_length);
     }
 
@@ -12,11 +12,46 @@
 #ifndef __M_SHELL__
 #define __M_SHELL__
 #include <stdint.h>
+#include "finsh.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 int msh_exec(char *cmd, uint32_t length);
 void msh_auto_complete(char *prefix);
 
+/* a command looked up once, for callers which run it repeatedly */
+struct msh_target {
+    const char *name;
+    int (*func)(int argc, char **argv);
+#ifdef FINSH_USING_REGISTRY
+    struct msh_cmd *reg;
+#endif
+};
+
+int msh_resolve(const char *name, struct msh_target *target);
+int msh_call(const struct msh_target *target, int argc, char **argv);
+
+#ifdef FINSH_USING_COMPLETE
+/*
+ * An argument completer lists all candidates of the word at argv[argc],
+ * argv[0..argc-1] are the words before it. The shell filters them by the
+ * typed prefix and caches them in the session until the line before the
+ * word changes, a command is run or msh_complete_invalidate() is called.
+ */
+typedef void (*msh_candidate_t)(const char *str, void *arg);
+typedef void (*msh_completer_t)(int argc, char **argv, msh_candidate_t candidate, void *arg);
+
+int msh_complete_register(const char *name, msh_completer_t completer);
+void msh_complete_invalidate(void);
+#endif
+
 int msh_exec_module(const char *cmd_line, int size);
 int msh_exec_script(const char *cmd_line, int size);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of typed arguments
+ */
+
+#include "msh_args.h"
+
+#ifdef FINSH_USING_ARGS
+
+static int args_digit(char ch, unsigned int base) {
+    unsigned int digit;
+
+    if (ch >= '0' && ch <= '9')
+        digit = ch - '0';
+    else if (ch >= 'a' && ch <= 'f')
+        digit = ch - 'a' + 10;
+    else if (ch >= 'A' && ch <= 'F')
+        digit = ch - 'A' + 10;
+    else
+        return -1;
+
+    return digit < base ? (int)digit : -1;
+}
+
+/* parse the whole string as an unsigned number, 0 on OK */
+static int args_parse_ulong(const char *str, unsigned int base, unsigned long *value) {
+    unsigned long result = 0;
+    int digit;
+
+    if (*str == '\0') return -1;
+
+    for (; *str; str++) {
+        digit = args_digit(*str, base);
+        if (digit < 0) return -1;
+        if (result > (~0UL - digit) / base) return -1;
+        result = result * base + digit;
+    }
+    *value = result;
+
+    return 0;
+}
+
+static int args_parse_int(const char *str, long *value) {
+    unsigned long magnitude;
+    unsigned int base = 10;
+    int negative = 0;
+
+    if (*str == '-' || *str == '+') negative = (*str++ == '-');
+    if (str[0] == '0' && (str[1] == 'x' || str[1] == 'X')) {
+        base = 16;
+        str += 2;
+    }
+
+    if (args_parse_ulong(str, base, &magnitude) != 0) return -1;
+    if (magnitude > (~0UL >> 1) + negative) return -1;
+
+    *value = negative ? (long)(0UL - magnitude) : (long)magnitude;
+
+    return 0;
+}
+
+static int args_parse_hex(const char *str, unsigned long *value) {
+    if (str[0] == '0' && (str[1] == 'x' || str[1] == 'X')) str += 2;
+
+    return args_parse_ulong(str, 16, value);
+}
+
+static int args_find_choice(const char *const *choices, const char *str) {
+    int index;
+
+    for (index = 0; choices[index]; index++) {
+        if (FINSH_STRNCMP(choices[index], str, FINSH_STRLEN(choices[index]) + 1) == 0) return index;
+    }
+
+    return -1;
+}
+
+/**
+ * @ingroup msh
+ *
+ * This function prints the usage line of a command built from its schema.
+ */
+void msh_args_usage(const char *name, const struct msh_cmd_args *cmd) {
+    const struct msh_arg *arg;
+    int optional = 0;
+
+    FINSH_PRINTF("Usage: %s", name);
+    for (arg = cmd->args; arg < &cmd->args[cmd->count]; arg++) {
+        const char *open = optional ? " [" : " <";
+        const char *close = optional ? "]" : ">";
+
+        switch (arg->type) {
+            case MSH_ARG_TYPE_INT:
+                FINSH_PRINTF("%s%s:%ld..%ld%s", open, arg->name, arg->min, arg->max, close);
+                break;
+            case MSH_ARG_TYPE_HEX:
+                FINSH_PRINTF("%s%s:hex%s", open, arg->name, close);
+                break;
+            case MSH_ARG_TYPE_ENUM: {
+                const char *const *choice;
+
+                FINSH_PUTS(open);
+                for (choice = arg->choices; *choice; choice++) FINSH_PRINTF("%s%s", choice == arg->choices ? "" : "|", *choice);
+                FINSH_PUTS(close);
+                break;
+            }
+            case MSH_ARG_TYPE_STR:
+                FINSH_PRINTF("%s%s%s", open, arg->name, close);
+                break;
+            case MSH_ARG_TYPE_FLAG:
+                FINSH_PRINTF(" [%s]", arg->name);
+                break;
+            case MSH_ARG_TYPE_OPTIONAL:
+                optional = 1;
+                break;
+        }
+    }
+    FINSH_PUTS("\r\n");
+}
+
+/* the value slot of a schema entry, the optional marker has none */
+static int args_slot(const struct msh_cmd_args *cmd, const struct msh_arg *arg) {
+    const struct msh_arg *index;
+    int slot = 0;
+
+    for (index = cmd->args; index < arg; index++) {
+        if (index->type != MSH_ARG_TYPE_OPTIONAL) slot++;
+    }
+
+    return slot;
+}
+
+static const struct msh_arg *args_find_flag(const struct msh_cmd_args *cmd, const char *str) {
+    const struct msh_arg *arg;
+
+    for (arg = cmd->args; arg < &cmd->args[cmd->count]; arg++) {
+        if (arg->type == MSH_ARG_TYPE_FLAG && FINSH_STRNCMP(arg->name, str, FINSH_STRLEN(arg->name) + 1) == 0) return arg;
+    }
+
+    return NULL;
+}
+
+/* the next positional entry after arg, NULL at the end of the schema */
+static const struct msh_arg *args_next_positional(const struct msh_cmd_args *cmd, const struct msh_arg *arg) {
+    for (; arg < &cmd->args[cmd->count]; arg++) {
+        if (arg->type != MSH_ARG_TYPE_FLAG && arg->type != MSH_ARG_TYPE_OPTIONAL) return arg;
+    }
+
+    return NULL;
+}
+
+/**
+ * @ingroup msh
+ *
+ * This function parses argv against the schema of a command and calls its
+ * handler with the typed values. It is called by the wrapper generated by
+ * MSH_CMD_EXPORT_ARGS.
+ *
+ * @return the return value of the handler, -1 on usage errors
+ */
+int msh_args_call(const char *name, const struct msh_cmd_args *cmd, int argc, char **argv) {
+    union msh_arg_value values[FINSH_ARGS_SCHEMA_MAX];
+    const struct msh_arg *arg, *next = cmd->args;
+    uint32_t present = 0;
+    int i, slot, ok;
+
+    if (cmd->count > FINSH_ARGS_SCHEMA_MAX) {
+        FINSH_PRINTF("%s: too many arguments in schema\r\n", name);
+        return -1;
+    }
+    FINSH_MEMSET(values, 0, sizeof(values));
+
+    for (i = 1; i < argc; i++) {
+        if (FINSH_STRNCMP(argv[i], "-h", 3) == 0 || FINSH_STRNCMP(argv[i], "--help", 7) == 0) {
+            msh_args_usage(name, cmd);
+            return 0;
+        }
+
+        arg = args_find_flag(cmd, argv[i]);
+        if (arg) {
+            slot = args_slot(cmd, arg);
+            values[slot].index = 1;
+            present |= 1UL << slot;
+            continue;
+        }
+
+        arg = args_next_positional(cmd, next);
+        if (arg == NULL) {
+            FINSH_PRINTF("%s: unexpected argument '%s'\r\n", name, argv[i]);
+            msh_args_usage(name, cmd);
+            return -1;
+        }
+        next = arg + 1;
+        slot = args_slot(cmd, arg);
+
+        switch (arg->type) {
+            case MSH_ARG_TYPE_INT:
+                ok = args_parse_int(argv[i], &values[slot].i) == 0 && values[slot].i >= arg->min && values[slot].i <= arg->max;
+                break;
+            case MSH_ARG_TYPE_HEX:
+                ok = args_parse_hex(argv[i], &values[slot].u) == 0;
+                break;
+            case MSH_ARG_TYPE_ENUM:
+                values[slot].index = args_find_choice(arg->choices, argv[i]);
+                ok = values[slot].index >= 0;
+                break;
+            default:
+                values[slot].s = argv[i];
+                ok = 1;
+                break;
+        }
+
+        if (!ok) {
+            FINSH_PRINTF("%s: invalid %s '%s'\r\n", name, arg->name ? arg->name : "value", argv[i]);
+            msh_args_usage(name, cmd);
+            return -1;
+        }
+        present |= 1UL << slot;
+    }
+
+    /* every positional argument before the optional marker is required */
+    for (arg = cmd->args; arg < &cmd->args[cmd->count] && arg->type != MSH_ARG_TYPE_OPTIONAL; arg++) {
+        if (arg->type != MSH_ARG_TYPE_FLAG && !(present & (1UL << args_slot(cmd, arg)))) {
+            FINSH_PRINTF("%s: missing %s\r\n", name, arg->name);
+            msh_args_usage(name, cmd);
+            return -1;
+        }
+    }
+
+    return cmd->func(values, present);
+}
+
+/**
+ * @ingroup msh
+ *
+ * This function lists the completion candidates of an argument: the flags
+ * which are not given yet and the choices of an enum.
+ *
+ * @param cmd the schema of the command
+ * @param argc the number of words before the one being completed
+ * @param argv the words before the one being completed, argv[0] is the command
+ * @param candidate called for each candidate
+ * @param arg the argument of candidate
+ */
+void msh_args_complete(const struct msh_cmd_args *cmd, int argc, char **argv, void (*candidate)(const char *str, void *arg),
+                       void *arg) {
+    const struct msh_arg *index, *next = cmd->args;
+    int i;
+
+    /* find the positional entry of the word being completed */
+    for (i = 1; i < argc && next; i++) {
+        if (args_find_flag(cmd, argv[i])) continue;
+
+        next = args_next_positional(cmd, next);
+        if (next) next++;
+    }
+    if (next) next = args_next_positional(cmd, next);
+
+    if (next && next->type == MSH_ARG_TYPE_ENUM) {
+        const char *const *choice;
+
+        for (choice = next->choices; *choice; choice++) candidate(*choice, arg);
+    }
+
+    for (index = cmd->args; index < &cmd->args[cmd->count]; index++) {
+        if (index->type != MSH_ARG_TYPE_FLAG) continue;
+
+        for (i = 1; i < argc; i++) {
+            if (FINSH_STRNCMP(index->name, argv[i], FINSH_STRLEN(index->name) + 1) == 0) break;
+        }
+        if (i == argc) candidate(index->name, arg);
+    }
+}
+
+#endif /* FINSH_USING_ARGS */
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of typed arguments
+ */
+
+#ifndef __MSH_ARGS_H__
+#define __MSH_ARGS_H__
+
+#include "shell.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef FINSH_USING_ARGS
+
+#ifndef FINSH_ARGS_SCHEMA_MAX
+#define FINSH_ARGS_SCHEMA_MAX 16 /* entries of a schema, the optional marker included */
+#endif
+#if FINSH_ARGS_SCHEMA_MAX > 32
+#error "FINSH_ARGS_SCHEMA_MAX is at most 32, the present mask has a bit for each value"
+#endif
+
+enum msh_arg_type {
+    MSH_ARG_TYPE_INT,      /* signed decimal or 0x hex, checked against min and max */
+    MSH_ARG_TYPE_HEX,      /* unsigned hex, with or without 0x, e.g. an address */
+    MSH_ARG_TYPE_ENUM,     /* one of choices, the value is its index */
+    MSH_ARG_TYPE_STR,      /* any word */
+    MSH_ARG_TYPE_FLAG,     /* the option "name" anywhere on the line, the value is 0 or 1 */
+    MSH_ARG_TYPE_OPTIONAL, /* marker, the arguments after it may be left out */
+};
+
+struct msh_arg {
+    const char *name;
+    uint8_t type;
+    long min, max;
+    const char *const *choices; /* NULL terminated */
+};
+
+union msh_arg_value {
+    long i;          /* MSH_ARG_TYPE_INT */
+    unsigned long u; /* MSH_ARG_TYPE_HEX */
+    int index;       /* MSH_ARG_TYPE_ENUM, MSH_ARG_TYPE_FLAG */
+    const char *s;   /* MSH_ARG_TYPE_STR */
+};
+
+/*
+ * The values are passed in the order of the schema, leaving out the
+ * optional marker. Bit n of present is set when value n was given.
+ */
+typedef int (*msh_args_func_t)(const union msh_arg_value *values, uint32_t present);
+
+struct msh_cmd_args {
+    const struct msh_arg *args;
+    uint8_t count;
+    msh_args_func_t func;
+};
+
+#define MSH_ARG_INT(name, min, max) {name, MSH_ARG_TYPE_INT, min, max, 0}
+#define MSH_ARG_HEX(name)           {name, MSH_ARG_TYPE_HEX, 0, 0, 0}
+#define MSH_ARG_ENUM(name, choices) {name, MSH_ARG_TYPE_ENUM, 0, 0, choices}
+#define MSH_ARG_STR(name)           {name, MSH_ARG_TYPE_STR, 0, 0, 0}
+#define MSH_ARG_FLAG(name)          {name, MSH_ARG_TYPE_FLAG, 0, 0, 0}
+#define MSH_ARG_OPTIONAL            {0, MSH_ARG_TYPE_OPTIONAL, 0, 0, 0}
+
+int msh_args_call(const char *name, const struct msh_cmd_args *cmd, int argc, char **argv);
+void msh_args_usage(const char *name, const struct msh_cmd_args *cmd);
+void msh_args_complete(const struct msh_cmd_args *cmd, int argc, char **argv, void (*candidate)(const char *str, void *arg),
+                       void *arg);
+
+/**
+ * @ingroup msh
+ *
+ * This macro exports a command with typed arguments to module shell. The
+ * arguments are parsed and checked by the shell, usage errors and "-h" show
+ * a usage line built from the schema, which also drives tab completion.
+ *
+ *     static const char *const modes[] = {"read", "write", NULL};
+ *     static int mem(const union msh_arg_value *v, uint32_t present) { ... }
+ *     MSH_CMD_EXPORT_ARGS(mem, access memory,
+ *                         MSH_ARG_ENUM("mode", modes), MSH_ARG_HEX("addr"),
+ *                         MSH_ARG_OPTIONAL, MSH_ARG_INT("count", 1, 256), MSH_ARG_FLAG("-v"));
+ *
+ * A schema of more than FINSH_ARGS_SCHEMA_MAX entries does not compile, the
+ * error names __margs_<command>_too_long.
+ *
+ * @param command is the name of the command, int command(const union msh_arg_value *, uint32_t).
+ * @param desc is the description of the command, which will show in help list.
+ */
+#define MSH_CMD_EXPORT_ARGS(command, desc, ...)                                                              \
+    static const struct msh_arg __margs_##command[] = {__VA_ARGS__};                                         \
+    typedef char __margs_##command##_too_long                                                                \
+        [sizeof(__margs_##command) / sizeof(__margs_##command[0]) <= FINSH_ARGS_SCHEMA_MAX ? 1 : -1];        \
+    static const struct msh_cmd_args __mcmd_##command = {                                                    \
+        __margs_##command, sizeof(__margs_##command) / sizeof(__margs_##command[0]), command};              \
+    static int __margv_##command(int argc, char **argv) {                                                    \
+        return msh_args_call(#command, &__mcmd_##command, argc, argv);                                       \
+    }                                                                                                        \
+    MSH_FUNCTION_EXPORT_CMD_EX(__margv_##command, command, desc, &__mcmd_##command)
+
+#endif /* FINSH_USING_ARGS */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
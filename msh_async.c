@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of async commands
+ */
+
+#include <stdlib.h>
+
+#include "msh_async.h"
+
+#ifdef FINSH_USING_ASYNC
+
+static struct finsh_async async_table[FINSH_ASYNC_MAX];
+
+/* the shell is at the prompt, the message goes above the half-typed line */
+static void async_finish(struct finsh_async *ctx) {
+    finsh_line_hide();
+    FINSH_PRINTF("[%d] Done %s: %d\r\n", (int)(ctx - async_table) + 1, ctx->name, ctx->ret);
+    finsh_line_show();
+    ctx->used = 0;
+}
+
+/*
+ * start an async command, called by the wrapper of MSH_ASYNC_CMD_EXPORT.
+ * The arguments are copied into the context because the shell line is
+ * reused as soon as the command waits.
+ */
+int finsh_async_spawn(finsh_async_func_t func, const char *name, int argc, char **argv) {
+    struct finsh_async *ctx = NULL;
+    uint32_t pos = 0;
+    int i;
+
+    for (i = 0; i < FINSH_ASYNC_MAX; i++) {
+        if (!async_table[i].used) {
+            ctx = &async_table[i];
+            break;
+        }
+    }
+
+    if (ctx == NULL) {
+        FINSH_PRINTF("%s: too many async commands.\r\n", name);
+        return -1;
+    }
+
+    if (argc > finsh_shell_current->arg_max) {
+        FINSH_PRINTF("%s: too many arguments.\r\n", name);
+        return -1;
+    }
+
+    /* each context has its own line and argv slots in the arena */
+    i = (int)(ctx - async_table);
+    FINSH_MEMSET(ctx, 0, sizeof(struct finsh_async));
+    ctx->line = &finsh_shell_current->async_lines[i * (finsh_shell_current->line_size + 1)];
+    ctx->argv = &finsh_shell_current->async_argv[i * finsh_shell_current->arg_max];
+    for (i = 0; i < argc; i++) {
+        uint32_t len = FINSH_STRLEN(argv[i]) + 1;
+
+        if (pos + len > finsh_shell_current->line_size + 1u) {
+            FINSH_PRINTF("%s: arguments too long.\r\n", name);
+            return -1;
+        }
+        FINSH_MEMCPY(&ctx->line[pos], argv[i], len);
+        ctx->argv[i] = &ctx->line[pos];
+        pos += len;
+    }
+    ctx->argc = argc;
+    ctx->func = func;
+    ctx->name = name;
+
+    /* run until the first wait, a command which never waits behaves like a normal one */
+    if (func(ctx) == FINSH_ASYNC_DONE) return ctx->ret;
+
+    ctx->used = 1;
+    FINSH_PRINTF("[%d] %s\r\n", (int)(ctx - async_table) + 1, name);
+
+    return 0;
+}
+
+/**
+ * @ingroup msh
+ *
+ * This function resumes the waiting async commands. It is called by
+ * finsh_run() whenever get_char has no input, call it from the main loop
+ * when get_char blocks.
+ */
+void finsh_async_poll(void) {
+    struct finsh_async *ctx;
+    uint32_t tick = finsh_get_tick();
+
+    for (ctx = async_table; ctx < &async_table[FINSH_ASYNC_MAX]; ctx++) {
+        if (!ctx->used) continue;
+
+        if (ctx->sleeping) {
+            if ((int32_t)(tick - ctx->wake_tick) < 0 && !ctx->cancel) continue;
+            ctx->sleeping = 0;
+        }
+
+        if (ctx->func(ctx) == FINSH_ASYNC_DONE) async_finish(ctx);
+    }
+}
+
+/* arm the wake up of FINSH_ASYNC_SLEEP, -1 when there is no tick source to wake it */
+int finsh_async_sleep(struct finsh_async *ctx, uint32_t ticks) {
+    if (finsh_shell_current->get_tick == NULL) {
+        FINSH_PRINTF("%s: no tick source to sleep on.\r\n", ctx->name);
+        return -1;
+    }
+
+    ctx->wake_tick = finsh_shell_current->get_tick() + ticks;
+    ctx->sleeping = 1;
+
+    return 0;
+}
+
+static int msh_jobs(int argc, char **argv) {
+    int i, j;
+
+    (void)argc;
+    (void)argv;
+
+    for (i = 0; i < FINSH_ASYNC_MAX; i++) {
+        if (!async_table[i].used) continue;
+
+        FINSH_PRINTF("[%d] %-10s", i + 1, async_table[i].sleeping ? "Sleeping" : "Waiting");
+        for (j = 0; j < async_table[i].argc; j++) FINSH_PRINTF(" %s", async_table[i].argv[j]);
+        FINSH_PUTS("\r\n");
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(msh_jobs, jobs, List running async commands.);
+
+static int msh_kill(int argc, char **argv) {
+    int id;
+
+    if (argc != 2) {
+        FINSH_PUTS("Usage: kill <job>\r\n");
+        return -1;
+    }
+
+    id = atoi(argv[1]);
+    if (id < 1 || id > FINSH_ASYNC_MAX || !async_table[id - 1].used) {
+        FINSH_PRINTF("kill: no such job %s\r\n", argv[1]);
+        return -1;
+    }
+
+    async_table[id - 1].cancel = 1;
+
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(msh_kill, kill, Cancel an async command.);
+
+#endif /* FINSH_USING_ASYNC */
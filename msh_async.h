@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of async commands
+ */
+
+#ifndef __MSH_ASYNC_H__
+#define __MSH_ASYNC_H__
+
+#include "shell.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef FINSH_USING_ASYNC
+
+#ifndef FINSH_ASYNC_LOCALS
+#define FINSH_ASYNC_LOCALS 4
+#endif
+
+/* return values of an async command */
+#define FINSH_ASYNC_WAITING 0
+#define FINSH_ASYNC_DONE    1
+
+/*
+ * The context of a running async command.
+ *
+ * Async commands are protothreads: each wait returns from the function and
+ * the next turn jumps back to the wait with a switch. LOCAL VARIABLES DO NOT
+ * KEEP THEIR VALUES ACROSS A WAIT, whatever is needed after a wait goes in
+ * locals[] or in the arguments. A switch statement of the command must not
+ * contain a wait either.
+ */
+struct finsh_async {
+    int (*func)(struct finsh_async *ctx);
+    const char *name;
+
+    uint16_t lc;       /* resume point, the line of the last wait */
+    uint8_t used : 1;
+    uint8_t sleeping : 1;
+    uint8_t cancel : 1; /* set by kill, waits end early */
+    uint32_t wake_tick;
+    int ret;
+
+    long locals[FINSH_ASYNC_LOCALS];
+
+    int argc;
+    char **argv; /* the arg_max slots of the context in the arena */
+    char *line;  /* the copy of the line in the arena, line_size + 1 bytes */
+};
+
+typedef int (*finsh_async_func_t)(struct finsh_async *ctx);
+
+#define FINSH_ASYNC_BEGIN(ctx) \
+    switch ((ctx)->lc) {       \
+        case 0:
+
+#define FINSH_ASYNC_END(ctx) \
+    }                        \
+    (ctx)->lc = 0;           \
+    return FINSH_ASYNC_DONE
+
+/* finish the command with a return code */
+#define FINSH_ASYNC_EXIT(ctx, code) \
+    do {                            \
+        (ctx)->ret = (code);        \
+        (ctx)->lc = 0;              \
+        return FINSH_ASYNC_DONE;    \
+    } while (0)
+
+/* give the other commands and the shell a turn */
+#define FINSH_ASYNC_YIELD(ctx)        \
+    do {                              \
+        (ctx)->lc = __LINE__;         \
+        return FINSH_ASYNC_WAITING;   \
+        case __LINE__:;               \
+    } while (0)
+
+/* resume once cond is true, cond is evaluated from the shell's poll loop */
+#define FINSH_ASYNC_WAIT_UNTIL(ctx, cond)                               \
+    do {                                                                \
+        (ctx)->lc = __LINE__;                                           \
+        if (0) {                                                        \
+            case __LINE__:;                                             \
+        }                                                               \
+        if (!(cond) && !(ctx)->cancel) return FINSH_ASYNC_WAITING;      \
+    } while (0)
+
+/*
+ * resume after ticks, the command is not called at all while it sleeps.
+ * Without a tick source the command fails at once with -1.
+ */
+#define FINSH_ASYNC_SLEEP(ctx, ticks)                                          \
+    do {                                                                       \
+        if (finsh_async_sleep((ctx), (ticks)) != 0) FINSH_ASYNC_EXIT(ctx, -1); \
+        (ctx)->lc = __LINE__;                                                  \
+        return FINSH_ASYNC_WAITING;                                            \
+        case __LINE__:;                                                        \
+    } while (0)
+
+#define FINSH_ASYNC_CANCELLED(ctx) ((ctx)->cancel)
+
+int finsh_async_spawn(finsh_async_func_t func, const char *name, int argc, char **argv);
+void finsh_async_poll(void);
+int finsh_async_sleep(struct finsh_async *ctx, uint32_t ticks);
+
+/**
+ * @ingroup msh
+ *
+ * This macro exports an async command to module shell. The command is
+ * started by the shell and resumed from its poll loop until it is done,
+ * the prompt comes back as soon as the command waits.
+ *
+ * @param command is the name of the command, int command(struct finsh_async *ctx).
+ * @param desc is the description of the command, which will show in help list.
+ */
+#define MSH_ASYNC_CMD_EXPORT(command, desc)                                                                     \
+    static int __fasync_##command(int argc, char **argv) { return finsh_async_spawn(command, #command, argc, argv); } \
+    MSH_FUNCTION_EXPORT_CMD(__fasync_##command, command, desc)
+
+#endif /* FINSH_USING_ASYNC */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of bench and time
+ */
+
+#include <stdlib.h>
+
+#include "msh.h"
+#include "msh_emit.h"
+#include "shell.h"
+
+#ifdef FINSH_USING_BENCH
+
+#ifndef FINSH_BENCH_MAX
+#define FINSH_BENCH_MAX 256 /* samples kept for the percentiles */
+#endif
+
+/*
+ * The measurements use finsh_get_clock(). A clock slower than
+ * BENCH_FINE_HZ, e.g. the shell tick when cfg.get_clock is not set, is too
+ * coarse to time one run: bench then times all runs at once and reports
+ * the mean only, and refuses results shorter than BENCH_MIN_TICKS.
+ */
+#define BENCH_FINE_HZ   1000000
+#define BENCH_MIN_TICKS 10
+#define BENCH_RUNS_MAX  1000000 /* of a coarse clock, no sample is kept */
+
+#define BENCH_CALIBRATE 32 /* calls of an empty command to measure the overhead */
+
+static uint32_t bench_samples[FINSH_BENCH_MAX];
+
+/*
+ * The arguments, copied again before each run as a command may change
+ * them. The saved copy and the one of the run are the two scratch lines of
+ * the arena, the argv of the run its scratch argv.
+ */
+static uint32_t bench_saved_size;
+static int bench_argc;
+
+/* the copy and the samples are shared, bench and time do not run inside bench */
+static uint8_t bench_busy;
+
+static int bench_nop(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    return 0;
+}
+
+static void bench_discard(const char *buf, uint32_t size) {
+    (void)buf;
+    (void)size;
+}
+
+static unsigned long bench_ns(uint32_t ticks) { return (unsigned long)((uint64_t)ticks * 1000000000 / finsh_get_clock_hz()); }
+
+static int bench_coarse(void) { return finsh_get_clock_hz() < BENCH_FINE_HZ; }
+
+/* keep a copy of the arguments, -1 when they do not fit */
+static int bench_save(int argc, char **argv) {
+    char *saved = finsh_shell_current->scratch;
+    uint32_t size = 0, length;
+    int i;
+
+    if (argc > finsh_shell_current->arg_max) return -1;
+
+    for (i = 0; i < argc; i++) {
+        length = FINSH_STRLEN(argv[i]) + 1;
+        if (size + length > finsh_shell_current->line_size + 1u) return -1;
+        FINSH_MEMCPY(&saved[size], argv[i], length);
+        size += length;
+    }
+    bench_saved_size = size;
+    bench_argc = argc;
+
+    return 0;
+}
+
+/* the saved arguments as they were before the first run */
+static char **bench_restore(void) {
+    char *line = &finsh_shell_current->scratch[finsh_shell_current->line_size + 1];
+    char **argv = finsh_shell_current->scratch_argv;
+    uint32_t pos = 0;
+    int i;
+
+    FINSH_MEMCPY(line, finsh_shell_current->scratch, bench_saved_size);
+    for (i = 0; i < bench_argc; i++) {
+        argv[i] = &line[pos];
+        pos += FINSH_STRLEN(&line[pos]) + 1;
+    }
+    argv[bench_argc] = NULL;
+
+    return argv;
+}
+
+/*
+ * Runs the target count times with the saved arguments, each run is timed
+ * when samples is not NULL. Returns the number of runs, fewer when one
+ * fails or the command is cancelled.
+ */
+static int bench_run(const struct msh_target *target, int count, uint32_t *samples, int *ret) {
+    int i;
+
+    for (i = 0; i < count; i++) {
+        char **argv = bench_restore();
+        uint32_t start = finsh_get_clock();
+
+        *ret = msh_call(target, bench_argc, argv);
+        if (samples) samples[i] = finsh_get_clock() - start;
+        if (*ret != 0) return i + 1;
+#ifdef FINSH_USING_CANCEL
+        if (finsh_cancelled()) return i + 1;
+#endif
+    }
+
+    return count;
+}
+
+static void bench_sort(uint32_t *samples, int count) {
+    int i, j;
+
+    for (i = 1; i < count; i++) {
+        uint32_t value = samples[i];
+
+        for (j = i; j > 0 && samples[j - 1] > value; j--) samples[j] = samples[j - 1];
+        samples[j] = value;
+    }
+}
+
+/* the calling overhead of the dispatch path and the clock, of one run or of count runs with a coarse clock */
+static uint32_t bench_overhead(int count) {
+    static char *argv[] = {"nop", NULL};
+    struct msh_target nop;
+    uint32_t start;
+    int ret;
+
+    FINSH_MEMSET(&nop, 0, sizeof(nop));
+    nop.name = "nop";
+    nop.func = bench_nop;
+    bench_save(1, argv);
+
+    if (bench_coarse()) {
+        start = finsh_get_clock();
+        bench_run(&nop, count, NULL, &ret);
+        return finsh_get_clock() - start;
+    }
+
+    bench_run(&nop, BENCH_CALIBRATE, bench_samples, &ret);
+    bench_sort(bench_samples, BENCH_CALIBRATE);
+
+    return bench_samples[BENCH_CALIBRATE / 2];
+}
+
+static void bench_report(const char *name, int count, uint32_t overhead) {
+    uint64_t total = 0;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        bench_samples[i] = bench_samples[i] > overhead ? bench_samples[i] - overhead : 0;
+        total += bench_samples[i];
+    }
+    bench_sort(bench_samples, count);
+
+#ifdef FINSH_USING_EMIT
+    finsh_emit_begin();
+    finsh_emit_str("name", name, "%s:");
+    finsh_emit_uint("runs", count, " %lu runs,");
+    finsh_emit_uint("min_ns", bench_ns(bench_samples[0]), " min %lu");
+    finsh_emit_uint("mean_ns", bench_ns(total / count), " mean %lu");
+    finsh_emit_uint("p50_ns", bench_ns(bench_samples[(count - 1) / 2]), " p50 %lu");
+    finsh_emit_uint("p99_ns", bench_ns(bench_samples[(count * 99 + 99) / 100 - 1]), " p99 %lu");
+    finsh_emit_uint("max_ns", bench_ns(bench_samples[count - 1]), " max %lu ns");
+    finsh_emit_uint("overhead_ns", bench_ns(overhead), " (overhead %lu ns)");
+    finsh_emit_end("\r\n");
+#else
+    FINSH_PRINTF("%s: %d runs, min %lu mean %lu p50 %lu p99 %lu max %lu ns (overhead %lu ns)\r\n", name, count,
+                 bench_ns(bench_samples[0]), bench_ns(total / count), bench_ns(bench_samples[(count - 1) / 2]),
+                 bench_ns(bench_samples[(count * 99 + 99) / 100 - 1]), bench_ns(bench_samples[count - 1]), bench_ns(overhead));
+#endif
+}
+
+/* the mean of count runs timed at once, with a coarse clock */
+static void bench_report_mean(const char *name, int count, uint32_t elapsed, uint32_t overhead) {
+    unsigned long mean = bench_ns(elapsed > overhead ? elapsed - overhead : 0) / count;
+
+#ifdef FINSH_USING_EMIT
+    finsh_emit_begin();
+    finsh_emit_str("name", name, "%s:");
+    finsh_emit_uint("runs", count, " %lu runs,");
+    finsh_emit_uint("mean_ns", mean, " mean %lu ns");
+    finsh_emit_uint("resolution_ns", bench_ns(1), " (clock of %lu ns, no percentiles)");
+    finsh_emit_end("\r\n");
+#else
+    FINSH_PRINTF("%s: %d runs, mean %lu ns (clock of %lu ns, no percentiles)\r\n", name, count, mean, bench_ns(1));
+#endif
+}
+
+static int bench_command(int argc, char **argv) {
+    struct msh_target target;
+    finsh_output_t output = NULL;
+    int count = 100, warmup = 0, quiet = 0, coarse = bench_coarse();
+    int i, runs, ret = 0;
+    uint32_t overhead, start, elapsed = 0;
+
+    for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+        if (FINSH_STRNCMP(argv[i], "-q", 3) == 0) {
+            quiet = 1;
+        } else if (FINSH_STRNCMP(argv[i], "-n", 3) == 0 && i + 1 < argc) {
+            count = atoi(argv[++i]);
+        } else if (FINSH_STRNCMP(argv[i], "-w", 3) == 0 && i + 1 < argc) {
+            warmup = atoi(argv[++i]);
+        } else {
+            break;
+        }
+    }
+
+    if (i >= argc || count <= 0 || count > (coarse ? BENCH_RUNS_MAX : FINSH_BENCH_MAX) || warmup < 0) {
+        FINSH_PRINTF("Usage: bench [-n 1..%d] [-w warmup] [-q] <command> [args...]\r\n", coarse ? BENCH_RUNS_MAX : FINSH_BENCH_MAX);
+        return -1;
+    }
+
+    if (msh_resolve(argv[i], &target) != 0) {
+        FINSH_PRINTF("%s: command not found.\r\n", argv[i]);
+        return -1;
+    }
+
+    overhead = bench_overhead(count);
+    if (bench_save(argc - i, &argv[i]) != 0) {
+        FINSH_PRINTF("%s: arguments too long.\r\n", argv[0]);
+        return -1;
+    }
+
+    if (quiet) output = finsh_set_output(bench_discard);
+    runs = bench_run(&target, warmup, NULL, &ret);
+    if (ret == 0) {
+        start = finsh_get_clock();
+        runs = bench_run(&target, count, coarse ? NULL : bench_samples, &ret);
+        elapsed = finsh_get_clock() - start;
+    }
+    if (quiet) finsh_set_output(output);
+
+    /* a failed run ends the benchmark, its return code is the result */
+    if (ret != 0) {
+        FINSH_PRINTF("%s: run %d returned %d\r\n", target.name, runs, ret);
+        return ret;
+    }
+
+    if (!coarse) {
+        bench_report(target.name, runs, overhead);
+    } else if (elapsed < BENCH_MIN_TICKS) {
+        FINSH_PRINTF("%s: %d runs took under %d ticks of %lu ns, use more runs or a high resolution clock\r\n",
+                     target.name, runs, BENCH_MIN_TICKS, bench_ns(1));
+        return -1;
+    } else {
+        bench_report_mean(target.name, runs, elapsed, runs == count ? overhead : overhead / count * runs);
+    }
+
+    return 0;
+}
+
+static int msh_bench(int argc, char **argv) {
+    int ret;
+
+    if (bench_busy) {
+        FINSH_PRINTF("%s: bench is already running.\r\n", argv[0]);
+        return -1;
+    }
+
+    bench_busy = 1;
+    ret = bench_command(argc, argv);
+    bench_busy = 0;
+
+    return ret;
+}
+MSH_CMD_EXPORT_ALIAS(msh_bench, bench, Run a command N times and report its latency.);
+
+static int msh_time(int argc, char **argv) {
+    struct msh_target target;
+    uint32_t overhead, start, elapsed;
+    int ret;
+
+    if (argc < 2) {
+        FINSH_PUTS("Usage: time <command> [args...]\r\n");
+        return -1;
+    }
+
+    if (bench_busy) {
+        FINSH_PRINTF("%s: bench is already running.\r\n", argv[0]);
+        return -1;
+    }
+
+    if (msh_resolve(argv[1], &target) != 0) {
+        FINSH_PRINTF("%s: command not found.\r\n", argv[1]);
+        return -1;
+    }
+
+    overhead = bench_overhead(1);
+
+    start = finsh_get_clock();
+    ret = msh_call(&target, argc - 1, &argv[1]);
+    elapsed = finsh_get_clock() - start;
+
+    /* a coarse clock can only tell that the command was short */
+    if (bench_coarse() && elapsed < BENCH_MIN_TICKS)
+        FINSH_PRINTF("%s: under %lu ns, returned %d\r\n", target.name, bench_ns(BENCH_MIN_TICKS), ret);
+    else
+        FINSH_PRINTF("%s: %lu ns, returned %d\r\n", target.name, bench_ns(elapsed > overhead ? elapsed - overhead : 0), ret);
+
+    return ret;
+}
+MSH_CMD_EXPORT_ALIAS(msh_time, time, Run a command once and report its latency.);
+
+#endif /* FINSH_USING_BENCH */
@@ -0,0 +1,357 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of bulk transfer mode
+ */
+
+#include "msh_bulk.h"
+#include "msh_rpc.h"
+#include "shell.h"
+
+#ifdef FINSH_USING_BULK
+
+#if FINSH_BULK_BLOCK > 0xFFFF || FINSH_BULK_WINDOW > 0xFF
+#error "FINSH_BULK_BLOCK must fit in 16 bits and FINSH_BULK_WINDOW in 8 bits"
+#endif
+
+enum bulk_mode {
+    BULK_IDLE,
+    BULK_RECV,
+    BULK_SEND,
+};
+
+enum bulk_stat {
+    BULK_WAIT_SOF,
+    BULK_WAIT_HEADER,
+    BULK_WAIT_PAYLOAD,
+};
+
+static struct {
+    enum bulk_mode mode;
+    enum bulk_stat stat;
+    uint16_t pos;
+    uint8_t header[FINSH_BULK_HEADER_SIZE - 1]; /* header without sof */
+    uint16_t rx_len;
+
+    /*
+     * Blocks are counted in 32 bits, the seq on the wire is the low 16 bits.
+     * recv: base is the next block expected.
+     * send: base is the first block not acked, next the next one to send
+     * and end the number of blocks, known once eof is set.
+     */
+    uint32_t base;
+    uint32_t next;
+    uint32_t end;
+    uint32_t size; /* recv: bytes received, send: bytes in all blocks once eof is set */
+    uint8_t eof;
+    uint8_t nak_sent;
+    uint8_t retry;
+    uint32_t tick; /* of the last progress */
+
+    finsh_bulk_recv_t recv;
+    finsh_bulk_send_t send;
+    finsh_bulk_done_t done;
+    void *ctx;
+    finsh_output_t link; /* the output of the shell before bulk mode */
+
+    uint8_t rx[FINSH_BULK_BLOCK + 2]; /* payload and crc */
+    uint8_t tx[FINSH_BULK_HEADER_SIZE + FINSH_BULK_BLOCK + 2];
+} bulk;
+
+/* send the frame built in bulk.tx, the payload is already at bulk.tx[FINSH_BULK_HEADER_SIZE] */
+static void bulk_send_frame(uint8_t type, uint16_t seq, uint16_t len) {
+    uint8_t *frame = bulk.tx;
+    uint16_t crc;
+
+    frame[0] = FINSH_BULK_SOF;
+    frame[1] = type;
+    frame[2] = seq & 0xFF;
+    frame[3] = seq >> 8;
+    frame[4] = len & 0xFF;
+    frame[5] = len >> 8;
+
+    crc = finsh_crc16(0xFFFF, &frame[1], FINSH_BULK_HEADER_SIZE - 1 + len);
+    frame[FINSH_BULK_HEADER_SIZE + len] = crc & 0xFF;
+    frame[FINSH_BULK_HEADER_SIZE + len + 1] = crc >> 8;
+
+    bulk.link((const char *)frame, FINSH_BULK_HEADER_SIZE + len + 2);
+}
+
+/* the shell output while in bulk mode, it would corrupt the frames */
+static void bulk_discard(const char *buf, uint32_t size) {
+    (void)buf;
+    (void)size;
+}
+
+static void bulk_input(uint8_t ch);
+
+static int bulk_start(enum bulk_mode mode, finsh_bulk_done_t done, void *ctx) {
+    if (bulk.mode != BULK_IDLE || finsh_shell_current->input_hook) return FINSH_BULK_EBUSY;
+
+    bulk.mode = mode;
+    bulk.stat = BULK_WAIT_SOF;
+    bulk.base = bulk.next = bulk.end = bulk.size = 0;
+    bulk.eof = bulk.nak_sent = bulk.retry = 0;
+    bulk.tick = finsh_get_tick();
+    bulk.done = done;
+    bulk.ctx = ctx;
+
+    bulk.link = finsh_set_output(bulk_discard);
+    finsh_set_input_hook(bulk_input);
+
+    return FINSH_BULK_OK;
+}
+
+static void bulk_finish(int result) {
+    finsh_bulk_done_t done = bulk.done;
+    uint32_t size = bulk.mode == BULK_SEND && !bulk.eof ? bulk.base * FINSH_BULK_BLOCK : bulk.size;
+
+    /* tell the host, unless it is the one which gave up */
+    if (result != FINSH_BULK_OK && result != FINSH_BULK_ECANCEL) bulk_send_frame(FINSH_BULK_CANCEL, 0, 0);
+
+    bulk.mode = BULK_IDLE;
+    finsh_set_output(bulk.link);
+    finsh_set_input_hook(NULL);
+    bulk.link = NULL;
+
+    if (done) done(bulk.ctx, result, size);
+    FINSH_PUTS(FINSH_PROMPT);
+}
+
+static void bulk_reply(uint8_t type, uint32_t seq) { bulk_send_frame(type, (uint16_t)seq, 0); }
+
+/* ACK 0 with the size of a block and of the window */
+static void bulk_ready(void) {
+    uint8_t *payload = &bulk.tx[FINSH_BULK_HEADER_SIZE];
+
+    payload[0] = FINSH_BULK_BLOCK & 0xFF;
+    payload[1] = FINSH_BULK_BLOCK >> 8;
+    payload[2] = FINSH_BULK_WINDOW;
+    bulk_send_frame(FINSH_BULK_ACK, 0, 3);
+}
+
+/* the block count of a seq on the wire, it is at most 0x7FFF blocks away from base */
+static uint32_t bulk_unwrap(uint16_t seq) { return bulk.base + (int16_t)(uint16_t)(seq - (uint16_t)bulk.base); }
+
+/* send blocks until the window is full, then END once every block is acked */
+static void bulk_pump(void) {
+    uint8_t *payload = &bulk.tx[FINSH_BULK_HEADER_SIZE];
+    int size;
+
+    while (bulk.next - bulk.base < FINSH_BULK_WINDOW && !(bulk.eof && bulk.next >= bulk.end)) {
+        size = bulk.send(bulk.ctx, bulk.next * FINSH_BULK_BLOCK, payload, FINSH_BULK_BLOCK);
+        if (size < 0) {
+            bulk_finish(FINSH_BULK_EABORT);
+            return;
+        }
+        if (size < FINSH_BULK_BLOCK && !bulk.eof) {
+            bulk.eof = 1;
+            bulk.end = bulk.next + (size > 0);
+            bulk.size = bulk.next * FINSH_BULK_BLOCK + size;
+        }
+        if (size == 0) break;
+
+        bulk_send_frame(FINSH_BULK_DATA, (uint16_t)bulk.next, size);
+        bulk.next++;
+    }
+
+    if (bulk.eof && bulk.base == bulk.end) bulk_reply(FINSH_BULK_END, bulk.end);
+}
+
+static void bulk_handle_recv(uint8_t type, uint16_t seq, uint16_t len) {
+    uint32_t count = bulk_unwrap(seq);
+
+    switch (type) {
+        case FINSH_BULK_DATA:
+            if (count == bulk.base) {
+                if (bulk.recv(bulk.ctx, bulk.size, bulk.rx, len) < 0) {
+                    bulk_finish(FINSH_BULK_EABORT);
+                    return;
+                }
+                bulk.base++;
+                bulk.size += len;
+                bulk.nak_sent = 0;
+                bulk.retry = 0;
+                bulk.tick = finsh_get_tick();
+                bulk_reply(FINSH_BULK_ACK, bulk.base);
+            } else if (count < bulk.base) {
+                /* sent again after a lost ACK */
+                bulk_reply(FINSH_BULK_ACK, bulk.base);
+            } else if (!bulk.nak_sent) {
+                bulk.nak_sent = 1;
+                bulk_reply(FINSH_BULK_NAK, bulk.base);
+            }
+            break;
+
+        case FINSH_BULK_END:
+            if (count == bulk.base) {
+                bulk_reply(FINSH_BULK_ACK, bulk.base + 1);
+                bulk_finish(FINSH_BULK_OK);
+            } else if (!bulk.nak_sent) {
+                bulk.nak_sent = 1;
+                bulk_reply(FINSH_BULK_NAK, bulk.base);
+            }
+            break;
+    }
+}
+
+static void bulk_handle_send(uint8_t type, uint16_t seq) {
+    uint32_t count = bulk_unwrap(seq);
+
+    switch (type) {
+        case FINSH_BULK_ACK:
+            if (bulk.eof && bulk.base == bulk.end && count == bulk.end + 1) {
+                bulk_finish(FINSH_BULK_OK);
+                return;
+            }
+            if (count <= bulk.base || count > bulk.next) break;
+
+            bulk.base = count;
+            bulk.retry = 0;
+            bulk.tick = finsh_get_tick();
+            bulk_pump();
+            break;
+
+        case FINSH_BULK_NAK:
+            if (count < bulk.base || count > bulk.next) break;
+
+            /* every block before the NAK is received, go back to it */
+            bulk.base = bulk.next = count;
+            bulk.tick = finsh_get_tick();
+            bulk_pump();
+            break;
+    }
+}
+
+static void bulk_handle(void) {
+    uint8_t type = bulk.header[0];
+    uint16_t seq = bulk.header[1] | (bulk.header[2] << 8);
+    uint16_t crc;
+
+    crc = finsh_crc16(0xFFFF, bulk.header, sizeof(bulk.header));
+    crc = finsh_crc16(crc, bulk.rx, bulk.rx_len);
+    if (crc != (bulk.rx[bulk.rx_len] | (bulk.rx[bulk.rx_len + 1] << 8))) {
+        if (bulk.mode == BULK_RECV && !bulk.nak_sent) {
+            bulk.nak_sent = 1;
+            bulk_reply(FINSH_BULK_NAK, bulk.base);
+        }
+        return;
+    }
+
+    if (type == FINSH_BULK_CANCEL)
+        bulk_finish(FINSH_BULK_ECANCEL);
+    else if (bulk.mode == BULK_RECV)
+        bulk_handle_recv(type, seq, bulk.rx_len);
+    else
+        bulk_handle_send(type, seq);
+}
+
+static void bulk_input(uint8_t ch) {
+    switch (bulk.stat) {
+        case BULK_WAIT_SOF:
+            if (ch == FINSH_BULK_SOF) {
+                bulk.stat = BULK_WAIT_HEADER;
+                bulk.pos = 0;
+            }
+            break;
+
+        case BULK_WAIT_HEADER:
+            bulk.header[bulk.pos++] = ch;
+            if (bulk.pos < sizeof(bulk.header)) break;
+
+            bulk.rx_len = bulk.header[3] | (bulk.header[4] << 8);
+            bulk.stat = bulk.rx_len > FINSH_BULK_BLOCK ? BULK_WAIT_SOF : BULK_WAIT_PAYLOAD;
+            bulk.pos = 0;
+            break;
+
+        case BULK_WAIT_PAYLOAD:
+            bulk.rx[bulk.pos++] = ch;
+            if (bulk.pos < bulk.rx_len + 2) break;
+
+            bulk.stat = BULK_WAIT_SOF;
+            bulk_handle();
+            break;
+    }
+}
+
+/**
+ * @ingroup finsh
+ *
+ * This function switches the console to bulk mode to receive data from the
+ * host, it is called by a command which returns right after it.
+ *
+ * @param recv called with each block in order
+ * @param done called at the end, may be NULL
+ * @param ctx passed to the callbacks
+ *
+ * @return FINSH_BULK_OK, FINSH_BULK_EBUSY when the console is in another mode
+ */
+int finsh_bulk_recv(finsh_bulk_recv_t recv, finsh_bulk_done_t done, void *ctx) {
+    int result = bulk_start(BULK_RECV, done, ctx);
+
+    if (result != FINSH_BULK_OK) return result;
+    bulk.recv = recv;
+    bulk_ready();
+
+    return FINSH_BULK_OK;
+}
+
+/**
+ * @ingroup finsh
+ *
+ * This function switches the console to bulk mode to send data to the
+ * host, it is called by a command which returns right after it.
+ *
+ * @param send called to fill each block, again when it is sent again
+ * @param done called at the end, may be NULL
+ * @param ctx passed to the callbacks
+ *
+ * @return FINSH_BULK_OK, FINSH_BULK_EBUSY when the console is in another mode
+ */
+int finsh_bulk_send(finsh_bulk_send_t send, finsh_bulk_done_t done, void *ctx) {
+    int result = bulk_start(BULK_SEND, done, ctx);
+
+    if (result != FINSH_BULK_OK) return result;
+    bulk.send = send;
+    bulk_pump();
+
+    return FINSH_BULK_OK;
+}
+
+/**
+ * @ingroup finsh
+ *
+ * This function handles the timeouts of a transfer, it is called by the
+ * shell when there is no input.
+ */
+void finsh_bulk_poll(void) {
+    uint32_t now;
+
+    if (bulk.mode == BULK_IDLE) return;
+
+    now = finsh_get_tick();
+    if (now - bulk.tick < FINSH_BULK_TIMEOUT) return;
+    bulk.tick = now;
+
+    if (++bulk.retry > FINSH_BULK_RETRY) {
+        bulk_finish(FINSH_BULK_ETIMEOUT);
+        return;
+    }
+
+    if (bulk.mode == BULK_RECV) {
+        /* the ACK may be lost, the first one also tells the host the board is ready */
+        if (bulk.base == 0)
+            bulk_ready();
+        else
+            bulk_reply(FINSH_BULK_ACK, bulk.base);
+    } else {
+        bulk.next = bulk.base;
+        bulk_pump();
+    }
+}
+
+#endif /* FINSH_USING_BULK */
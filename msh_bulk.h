@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of bulk transfer mode
+ */
+
+#ifndef __MSH_BULK_H__
+#define __MSH_BULK_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Frame layout, the same as the rpc mode, multi-byte fields are little endian:
+ *
+ *   | sof | type | seq (2) | len (2) | payload (len) | crc16 (2) |
+ *
+ * FINSH_BULK_DATA   a block of data, every block but the last is FINSH_BULK_BLOCK bytes
+ * FINSH_BULK_END    no more blocks, seq is the seq after the last block
+ * FINSH_BULK_ACK    seq is the next block expected, every block before it is received
+ * FINSH_BULK_NAK    seq is the next block expected, the blocks from it must be sent again
+ * FINSH_BULK_CANCEL the transfer is aborted
+ *
+ * Upload (host to board): the board sends ACK 0 with the payload
+ * block size (2) | window (1) when it is ready. The host may send up to
+ * window blocks after the last ACK, then END, which the board acks with
+ * seq + 1 before it goes back to the prompt.
+ *
+ * Download (board to host): the board sends up to FINSH_BULK_WINDOW blocks
+ * after the last ACK, then END once every block is acked, the host acks
+ * END with seq + 1.
+ *
+ * Errors are recovered with go-back-N: a receiver drops every block after
+ * a missing one and sends NAK once, a sender goes back to the last ACK
+ * when it gets NAK or nothing for FINSH_BULK_TIMEOUT ticks.
+ */
+#define FINSH_BULK_SOF 0xA5
+
+#define FINSH_BULK_DATA   0x10
+#define FINSH_BULK_END    0x11
+#define FINSH_BULK_ACK    0x90
+#define FINSH_BULK_NAK    0x91
+#define FINSH_BULK_CANCEL 0x98
+
+#define FINSH_BULK_HEADER_SIZE 6 /* sof, type, seq, len */
+
+#define FINSH_BULK_OK       0
+#define FINSH_BULK_ECANCEL -1 /* cancelled by the host */
+#define FINSH_BULK_ETIMEOUT -2 /* FINSH_BULK_RETRY timeouts in a row */
+#define FINSH_BULK_EABORT   -3 /* a callback returned an error */
+#define FINSH_BULK_EBUSY    -4 /* a transfer is running */
+
+#ifdef FINSH_USING_BULK
+
+#ifndef FINSH_BULK_BLOCK
+#define FINSH_BULK_BLOCK 1024
+#endif
+#ifndef FINSH_BULK_WINDOW
+#define FINSH_BULK_WINDOW 8 /* blocks in flight */
+#endif
+#ifndef FINSH_BULK_TIMEOUT
+#define FINSH_BULK_TIMEOUT FINSH_TICK_PER_SECOND
+#endif
+#ifndef FINSH_BULK_RETRY
+#define FINSH_BULK_RETRY 10
+#endif
+
+/*
+ * Called with each block in order, data points into the receive buffer and
+ * is valid until the callback returns. Return a negative value to abort.
+ */
+typedef int (*finsh_bulk_recv_t)(void *ctx, uint32_t offset, const uint8_t *data, uint32_t size);
+
+/*
+ * Fills buf with the data at offset, straight into the frame being sent.
+ * Returns the number of bytes, less than size only at the end, or a
+ * negative value to abort. A block is read again when it is sent again,
+ * so the same offset must give the same data.
+ */
+typedef int (*finsh_bulk_send_t)(void *ctx, uint32_t offset, uint8_t *buf, uint32_t size);
+
+/* Called once the console is back in text mode, size is the bytes transferred */
+typedef void (*finsh_bulk_done_t)(void *ctx, int result, uint32_t size);
+
+/*
+ * A command switches the console to bulk mode and returns, the transfer
+ * runs from the input of the shell and the timeouts from its idle poll, so
+ * get_char must return -1 when there is no input. Text written by the
+ * shell while in bulk mode is dropped.
+ */
+int finsh_bulk_recv(finsh_bulk_recv_t recv, finsh_bulk_done_t done, void *ctx);
+int finsh_bulk_send(finsh_bulk_send_t send, finsh_bulk_done_t done, void *ctx);
+void finsh_bulk_poll(void);
+
+#endif /* FINSH_USING_BULK */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the command registry
+ */
+
+#include "shell.h"
+
+#ifdef FINSH_USING_REGISTRY
+
+#if FINSH_REGISTRY_MAX > 0x10000 - MSH_CMD_ID_BASE
+#error "FINSH_REGISTRY_MAX is larger than the ids of registered commands"
+#endif
+
+/* registered commands, sorted by name and by id */
+static struct msh_cmd *msh_cmds[FINSH_REGISTRY_MAX];
+static struct msh_cmd *msh_cmd_ids[FINSH_REGISTRY_MAX];
+static int msh_cmd_num;
+static uint16_t msh_cmd_next_id = MSH_CMD_ID_BASE;
+
+/* compares name with the first size characters of str, like strcmp */
+static int msh_cmd_compare(const char *name, const char *str, int size) {
+    int result = FINSH_STRNCMP(name, str, size);
+
+    if (result == 0 && name[size] != '\0') result = 1;
+
+    return result;
+}
+
+/* the index of str, or -(insertion point) - 1 when it is not registered */
+static int msh_cmd_search(const char *str, int size) {
+    int low = 0, high = msh_cmd_num - 1;
+
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        int result = msh_cmd_compare(msh_cmds[mid]->name, str, size);
+
+        if (result == 0) return mid;
+        if (result < 0)
+            low = mid + 1;
+        else
+            high = mid - 1;
+    }
+
+    return -low - 1;
+}
+
+/* the index of id in msh_cmd_ids, or -(insertion point) - 1 when it is not used */
+static int msh_cmd_search_id(uint16_t id) {
+    int low = 0, high = msh_cmd_num - 1;
+
+    while (low <= high) {
+        int mid = (low + high) / 2;
+
+        if (msh_cmd_ids[mid]->id == id) return mid;
+        if (msh_cmd_ids[mid]->id < id)
+            low = mid + 1;
+        else
+            high = mid - 1;
+    }
+
+    return -low - 1;
+}
+
+/**
+ * @ingroup msh
+ *
+ * This function registers a command at run time. The command and its name
+ * must stay valid until it is unregistered.
+ *
+ * @return 0 on OK, -1 when the name is taken or the registry is full
+ */
+int msh_cmd_register(struct msh_cmd *cmd) {
+    int index;
+
+    if (cmd == NULL || cmd->name == NULL || cmd->func == NULL) return -1;
+    if (msh_cmd_num >= FINSH_REGISTRY_MAX) return -1;
+
+    index = msh_cmd_search(cmd->name, FINSH_STRLEN(cmd->name));
+    if (index >= 0) return -1;
+
+    index = -index - 1;
+    FINSH_MEMMOVE(&msh_cmds[index + 1], &msh_cmds[index], (msh_cmd_num - index) * sizeof(msh_cmds[0]));
+    msh_cmds[index] = cmd;
+
+    /* the next id not in use, in order, so the ids of removed commands come back last */
+    while ((index = msh_cmd_search_id(msh_cmd_next_id)) >= 0) {
+        if (++msh_cmd_next_id == 0) msh_cmd_next_id = MSH_CMD_ID_BASE;
+    }
+    cmd->id = msh_cmd_next_id;
+    if (++msh_cmd_next_id == 0) msh_cmd_next_id = MSH_CMD_ID_BASE;
+    index = -index - 1;
+    FINSH_MEMMOVE(&msh_cmd_ids[index + 1], &msh_cmd_ids[index], (msh_cmd_num - index) * sizeof(msh_cmd_ids[0]));
+    msh_cmd_ids[index] = cmd;
+    msh_cmd_num++;
+
+    return 0;
+}
+
+/**
+ * @ingroup msh
+ *
+ * This function removes a registered command.
+ *
+ * @return 0 on OK, -1 when the command is not registered
+ */
+int msh_cmd_unregister(struct msh_cmd *cmd) {
+    int index;
+
+    if (cmd == NULL || cmd->name == NULL) return -1;
+
+    index = msh_cmd_search(cmd->name, FINSH_STRLEN(cmd->name));
+    if (index < 0 || msh_cmds[index] != cmd) return -1;
+
+    FINSH_MEMMOVE(&msh_cmds[index], &msh_cmds[index + 1], (msh_cmd_num - index - 1) * sizeof(msh_cmds[0]));
+    index = msh_cmd_search_id(cmd->id);
+    FINSH_MEMMOVE(&msh_cmd_ids[index], &msh_cmd_ids[index + 1], (msh_cmd_num - index - 1) * sizeof(msh_cmd_ids[0]));
+    msh_cmd_num--;
+
+    return 0;
+}
+
+/**
+ * @ingroup msh
+ *
+ * This function finds a registered command by the first size characters
+ * of name, in O(log n).
+ */
+struct msh_cmd *msh_cmd_find(const char *name, int size) {
+    int index = msh_cmd_search(name, size);
+
+    return index >= 0 ? msh_cmds[index] : NULL;
+}
+
+int msh_cmd_count(void) { return msh_cmd_num; }
+
+struct msh_cmd *msh_cmd_at(int index) { return (index >= 0 && index < msh_cmd_num) ? msh_cmds[index] : NULL; }
+
+/**
+ * @ingroup msh
+ *
+ * This function finds a registered command by its id, in O(log n).
+ */
+struct msh_cmd *msh_cmd_by_id(uint16_t id) {
+    int index = msh_cmd_search_id(id);
+
+    return index >= 0 ? msh_cmd_ids[index] : NULL;
+}
+
+#endif /* FINSH_USING_REGISTRY */
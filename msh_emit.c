@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of structured output
+ */
+
+#include "msh_emit.h"
+#include "shell.h"
+
+#ifdef FINSH_USING_EMIT
+
+/* CBOR major types */
+#define CBOR_UINT   0x00
+#define CBOR_NINT   0x20
+#define CBOR_TEXT   0x60
+#define CBOR_FALSE  0xF4
+#define CBOR_TRUE   0xF5
+#define CBOR_INDEF  0xBF /* map of indefinite length */
+#define CBOR_BREAK  0xFF
+
+static uint8_t emit_formats[FINSH_SESSION_MAX]; /* FINSH_EMIT_TEXT until a session asks for another */
+static uint8_t emit_first;                     /* no field emitted yet in this record */
+
+#define EMIT_FORMAT emit_formats[finsh_get_session()]
+
+/**
+ * @ingroup msh
+ *
+ * This function sets the output format of the records of the current
+ * session, e.g. an rpc client may ask for CBOR while the console stays in
+ * text.
+ *
+ * @param format FINSH_EMIT_TEXT, FINSH_EMIT_JSON or FINSH_EMIT_CBOR
+ *
+ * @return 0 on success, -1 on an unknown format
+ */
+int finsh_emit_set_format(int format) {
+    if (format < FINSH_EMIT_TEXT || format > FINSH_EMIT_CBOR) return -1;
+
+    EMIT_FORMAT = (uint8_t)format;
+    return 0;
+}
+
+int finsh_emit_get_format(void) { return EMIT_FORMAT; }
+
+/*
+ * A text format is used only when it has a single conversion for the type
+ * of the field: longs is 1 for the 'l' modifier, convs the conversions
+ * allowed. Anything else prints "key=value " instead.
+ */
+static int emit_text_fmt_ok(const char *fmt, int longs, const char *convs) {
+    const char *conv;
+    int count = 0;
+
+    if (fmt == NULL) return 0;
+
+    for (; *fmt; fmt++) {
+        if (*fmt != '%') continue;
+        if (*++fmt == '%') continue;
+
+        while (*fmt == '-' || *fmt == '+' || *fmt == ' ' || *fmt == '#' || *fmt == '0') fmt++;
+        while (*fmt >= '0' && *fmt <= '9') fmt++;
+        if (*fmt == '.') {
+            fmt++;
+            while (*fmt >= '0' && *fmt <= '9') fmt++;
+        }
+        if (longs && *fmt++ != 'l') return 0;
+        for (conv = convs; *conv && *conv != *fmt; conv++);
+        if (*fmt == '\0' || *conv == '\0') return 0;
+        count++;
+    }
+
+    return count == 1;
+}
+
+static void cbor_head(uint8_t major, uint64_t value) {
+    uint8_t head[9];
+    uint32_t size;
+
+    if (value < 24) {
+        head[0] = major | value;
+        size = 1;
+    } else if (value <= 0xFF) {
+        head[0] = major | 24;
+        head[1] = value;
+        size = 2;
+    } else if (value <= 0xFFFF) {
+        head[0] = major | 25;
+        head[1] = value >> 8;
+        head[2] = value;
+        size = 3;
+    } else if (value <= 0xFFFFFFFFUL) {
+        head[0] = major | 26;
+        head[1] = value >> 24;
+        head[2] = value >> 16;
+        head[3] = value >> 8;
+        head[4] = value;
+        size = 5;
+    } else {
+        int i;
+
+        head[0] = major | 27;
+        for (i = 1; i <= 8; i++) head[i] = value >> (64 - 8 * i);
+        size = 9;
+    }
+
+    finsh_write((const char *)head, size);
+}
+
+static void cbor_text(const char *str) {
+    uint32_t length = FINSH_STRLEN(str);
+
+    cbor_head(CBOR_TEXT, length);
+    finsh_write(str, length);
+}
+
+static void json_string(const char *str) {
+    const char *run = str;
+
+    finsh_write("\"", 1);
+    for (; *str; str++) {
+        unsigned char ch = (unsigned char)*str;
+
+        if (ch >= 0x20 && ch != '"' && ch != '\\') continue;
+
+        /* write the plain run, then the escaped character */
+        finsh_write(run, str - run);
+        if (ch == '"' || ch == '\\') {
+            char escape[2] = {'\\', (char)ch};
+            finsh_write(escape, 2);
+        } else {
+            FINSH_PRINTF("\\u%04x", ch);
+        }
+        run = str + 1;
+    }
+    finsh_write(run, str - run);
+    finsh_write("\"", 1);
+}
+
+/* the key of a field, returns 1 when the caller should write the value */
+static int emit_key(const char *key) {
+    switch (EMIT_FORMAT) {
+        case FINSH_EMIT_JSON:
+            if (!emit_first) finsh_write(",", 1);
+            json_string(key);
+            finsh_write(":", 1);
+            break;
+        case FINSH_EMIT_CBOR:
+            cbor_text(key);
+            break;
+        default:
+            return 0;
+    }
+    emit_first = 0;
+
+    return 1;
+}
+
+/**
+ * @ingroup msh
+ *
+ * This function starts a record.
+ */
+void finsh_emit_begin(void) {
+    emit_first = 1;
+
+    if (EMIT_FORMAT == FINSH_EMIT_JSON)
+        finsh_write("{", 1);
+    else if (EMIT_FORMAT == FINSH_EMIT_CBOR) {
+        uint8_t indef = CBOR_INDEF;
+        finsh_write((const char *)&indef, 1);
+    }
+}
+
+/**
+ * @ingroup msh
+ *
+ * This function ends a record.
+ *
+ * @param text the text printed after the record in text mode, may be NULL
+ */
+void finsh_emit_end(const char *text) {
+    if (EMIT_FORMAT == FINSH_EMIT_JSON) {
+        finsh_write("}\r\n", 3);
+    } else if (EMIT_FORMAT == FINSH_EMIT_CBOR) {
+        uint8_t brk = CBOR_BREAK;
+        finsh_write((const char *)&brk, 1);
+    } else if (text) {
+        finsh_write(text, FINSH_STRLEN(text));
+    }
+}
+
+/**
+ * @ingroup msh
+ *
+ * This function prints text for humans only, such as table headers. It
+ * is dropped in machine formats.
+ */
+void finsh_emit_text(const char *text) {
+    if (EMIT_FORMAT == FINSH_EMIT_TEXT) finsh_write(text, FINSH_STRLEN(text));
+}
+
+void finsh_emit_str(const char *key, const char *value, const char *text_fmt) {
+    if (value == NULL) value = "";
+
+    if (!emit_key(key)) {
+        if (emit_text_fmt_ok(text_fmt, 0, "s"))
+            FINSH_PRINTF(text_fmt, value);
+        else
+            FINSH_PRINTF("%s=%s ", key, value);
+        return;
+    }
+
+    if (EMIT_FORMAT == FINSH_EMIT_JSON)
+        json_string(value);
+    else
+        cbor_text(value);
+}
+
+void finsh_emit_int(const char *key, long value, const char *text_fmt) {
+    if (!emit_key(key)) {
+        if (emit_text_fmt_ok(text_fmt, 1, "di"))
+            FINSH_PRINTF(text_fmt, value);
+        else
+            FINSH_PRINTF("%s=%ld ", key, value);
+        return;
+    }
+
+    if (EMIT_FORMAT == FINSH_EMIT_JSON)
+        FINSH_PRINTF("%ld", value);
+    else if (value < 0)
+        cbor_head(CBOR_NINT, (uint64_t)(-1 - value));
+    else
+        cbor_head(CBOR_UINT, (uint64_t)value);
+}
+
+void finsh_emit_uint(const char *key, unsigned long value, const char *text_fmt) {
+    if (!emit_key(key)) {
+        if (emit_text_fmt_ok(text_fmt, 1, "uxXo"))
+            FINSH_PRINTF(text_fmt, value);
+        else
+            FINSH_PRINTF("%s=%lu ", key, value);
+        return;
+    }
+
+    if (EMIT_FORMAT == FINSH_EMIT_JSON)
+        FINSH_PRINTF("%lu", value);
+    else
+        cbor_head(CBOR_UINT, value);
+}
+
+void finsh_emit_bool(const char *key, int value, const char *text_fmt) {
+    const char *str = value ? "true" : "false";
+
+    if (!emit_key(key)) {
+        if (emit_text_fmt_ok(text_fmt, 0, "s"))
+            FINSH_PRINTF(text_fmt, str);
+        else
+            FINSH_PRINTF("%s=%s ", key, str);
+        return;
+    }
+
+    if (EMIT_FORMAT == FINSH_EMIT_JSON) {
+        finsh_write(str, FINSH_STRLEN(str));
+    } else {
+        uint8_t simple = value ? CBOR_TRUE : CBOR_FALSE;
+        finsh_write((const char *)&simple, 1);
+    }
+}
+
+static int msh_format(int argc, char **argv) {
+    static const char *const names[] = {"text", "json", "cbor"};
+    int i;
+
+    /* the format of the session the command runs in */
+    if (argc == 1) {
+        FINSH_PRINTF("%s\r\n", names[EMIT_FORMAT]);
+        return 0;
+    }
+
+    for (i = FINSH_EMIT_TEXT; i <= FINSH_EMIT_CBOR; i++) {
+        if (FINSH_STRNCMP(argv[1], names[i], FINSH_STRLEN(names[i]) + 1) == 0) return finsh_emit_set_format(i);
+    }
+
+    FINSH_PUTS("Usage: format [text|json|cbor]\r\n");
+    return -1;
+}
+MSH_CMD_EXPORT_ALIAS(msh_format, format, Set the output format of records.);
+
+#endif /* FINSH_USING_EMIT */
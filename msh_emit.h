@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of structured output
+ */
+
+#ifndef __MSH_EMIT_H__
+#define __MSH_EMIT_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef FINSH_USING_EMIT
+
+/* output formats of the records */
+#define FINSH_EMIT_TEXT 0 /* human readable, laid out by the text formats of the fields */
+#define FINSH_EMIT_JSON 1 /* one compact JSON object per line, ended by "\r\n" */
+#define FINSH_EMIT_CBOR 2 /* one CBOR map per record */
+
+/*
+ * A record is a list of typed key/value fields, written to the shell output
+ * as they are emitted:
+ *
+ *     finsh_emit_begin();
+ *     finsh_emit_str("name", name, "%-16s");
+ *     finsh_emit_uint("size", size, " %8lu");
+ *     finsh_emit_end("\r\n");
+ *
+ * The text format of a field is the printf format used in text mode, with
+ * a single conversion for the type of the field: %s for strings and bools,
+ * %ld for int and %lu or %lx for uint, flags and width allowed. NULL, or a
+ * format which does not match, prints "key=value ". The format is per
+ * session, see finsh_set_session(). Nothing is buffered and nothing is
+ * allocated.
+ */
+int finsh_emit_set_format(int format);
+int finsh_emit_get_format(void);
+
+void finsh_emit_begin(void);
+void finsh_emit_end(const char *text);
+void finsh_emit_text(const char *text);
+
+void finsh_emit_str(const char *key, const char *value, const char *text_fmt);
+void finsh_emit_int(const char *key, long value, const char *text_fmt);
+void finsh_emit_uint(const char *key, unsigned long value, const char *text_fmt);
+void finsh_emit_bool(const char *key, int value, const char *text_fmt);
+
+#endif /* FINSH_USING_EMIT */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the log sink
+ */
+
+#include "msh_log.h"
+#include "shell.h"
+
+#ifdef FINSH_USING_LOG
+
+#include <stdarg.h>
+#include <stdatomic.h>
+
+#if (FINSH_LOG_SLOTS & (FINSH_LOG_SLOTS - 1)) != 0
+#error "FINSH_LOG_SLOTS must be a power of two"
+#endif
+
+/*
+ * A bounded queue with a sequence number per slot: a producer claims a
+ * position with a compare-and-swap of the tail and publishes the slot by
+ * storing position + 1 in its sequence, the shell frees it by storing
+ * position + FINSH_LOG_SLOTS. The stored sequence is relative to the index
+ * of the slot, so the zeroed ring is ready before the shell starts.
+ */
+struct log_slot {
+    _Atomic uint32_t seq;
+    uint16_t size;
+    char buf[FINSH_LOG_LINE_MAX + 1]; /* room for the '\0' of finsh_vsnprintf() */
+};
+
+static struct log_slot log_slots[FINSH_LOG_SLOTS];
+static _Atomic uint32_t log_tail;
+static uint32_t log_head; /* the shell is the only consumer */
+
+static _Atomic uint32_t log_written;
+static _Atomic uint32_t log_dropped;
+static _Atomic uint32_t log_truncated;
+
+#define LOG_SLOT(pos) ((pos) & (FINSH_LOG_SLOTS - 1))
+
+/* claims the slot at the tail for a message, NULL when the ring is full */
+static struct log_slot *log_claim(uint32_t *claimed) {
+    struct log_slot *slot;
+    uint32_t pos = atomic_load_explicit(&log_tail, memory_order_relaxed);
+
+    for (;;) {
+        int32_t diff;
+
+        slot = &log_slots[LOG_SLOT(pos)];
+        diff = (int32_t)(atomic_load_explicit(&slot->seq, memory_order_acquire) + LOG_SLOT(pos) - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&log_tail, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            atomic_fetch_add_explicit(&log_dropped, 1, memory_order_relaxed);
+            return NULL;
+        } else {
+            pos = atomic_load_explicit(&log_tail, memory_order_relaxed);
+        }
+    }
+
+    *claimed = pos;
+    return slot;
+}
+
+/* hands the claimed slot to the shell, a size over the line size is cut */
+static void log_publish(struct log_slot *slot, uint32_t pos, uint32_t size) {
+    if (size > FINSH_LOG_LINE_MAX) {
+        size = FINSH_LOG_LINE_MAX;
+        atomic_fetch_add_explicit(&log_truncated, 1, memory_order_relaxed);
+    }
+    slot->size = size;
+    atomic_store_explicit(&slot->seq, pos + 1 - LOG_SLOT(pos), memory_order_release);
+    atomic_fetch_add_explicit(&log_written, 1, memory_order_relaxed);
+}
+
+/**
+ * @ingroup finsh
+ *
+ * This function queues a log message, it never blocks.
+ *
+ * @return 0 on OK, -1 when the message is dropped
+ */
+int finsh_log_write(const char *buf, uint32_t size) {
+    uint32_t pos;
+    struct log_slot *slot = log_claim(&pos);
+
+    if (slot == NULL) return -1;
+    FINSH_MEMCPY(slot->buf, buf, size < FINSH_LOG_LINE_MAX ? size : FINSH_LOG_LINE_MAX);
+    log_publish(slot, pos, size);
+
+    return 0;
+}
+
+/* formatted straight into the slot */
+int finsh_log_printf(const char *fmt, ...) {
+    va_list args;
+    uint32_t pos;
+    int length;
+    struct log_slot *slot = log_claim(&pos);
+
+    if (slot == NULL) return -1;
+    va_start(args, fmt);
+    length = finsh_vsnprintf(slot->buf, sizeof(slot->buf), fmt, args);
+    va_end(args);
+    log_publish(slot, pos, length < 0 ? 0 : (uint32_t)length);
+
+    return length < 0 ? -1 : 0;
+}
+
+static int log_pending(void) {
+    struct log_slot *slot = &log_slots[LOG_SLOT(log_head)];
+
+    return atomic_load_explicit(&slot->seq, memory_order_acquire) + LOG_SLOT(log_head) == log_head + 1;
+}
+
+/**
+ * @ingroup finsh
+ *
+ * This function writes the queued logs above the line being edited. It is
+ * called by the shell thread when there is no input.
+ */
+void finsh_log_drain(void) {
+    if (finsh_shell_current == NULL || finsh_shell_current->input_hook || !log_pending()) return;
+
+    finsh_line_hide();
+
+    while (log_pending()) {
+        struct log_slot *slot = &log_slots[LOG_SLOT(log_head)];
+
+        finsh_write(slot->buf, slot->size);
+        if (slot->size == 0 || slot->buf[slot->size - 1] != '\n') FINSH_PUTS("\r\n");
+
+        atomic_store_explicit(&slot->seq, log_head + FINSH_LOG_SLOTS - LOG_SLOT(log_head), memory_order_release);
+        log_head++;
+    }
+
+    finsh_line_show();
+}
+
+void finsh_log_counters(uint32_t *written, uint32_t *dropped, uint32_t *truncated) {
+    if (written) *written = atomic_load_explicit(&log_written, memory_order_relaxed);
+    if (dropped) *dropped = atomic_load_explicit(&log_dropped, memory_order_relaxed);
+    if (truncated) *truncated = atomic_load_explicit(&log_truncated, memory_order_relaxed);
+}
+
+static int msh_log(int argc, char **argv) {
+    uint32_t written, dropped, truncated;
+
+    (void)argc;
+    (void)argv;
+
+    finsh_log_counters(&written, &dropped, &truncated);
+    FINSH_PRINTF("written %lu, dropped %lu, truncated %lu\r\n", (unsigned long)written, (unsigned long)dropped,
+                 (unsigned long)truncated);
+
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(msh_log, log, Show the counters of the log sink.);
+
+#endif /* FINSH_USING_LOG */
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the log sink
+ */
+
+#ifndef __MSH_LOG_H__
+#define __MSH_LOG_H__
+
+#include <stdint.h>
+
+#include "finsh.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef FINSH_USING_LOG
+
+#ifndef FINSH_LOG_SLOTS
+#define FINSH_LOG_SLOTS 16 /* messages queued, a power of two */
+#endif
+#ifndef FINSH_LOG_LINE_MAX
+#define FINSH_LOG_LINE_MAX 120 /* longer messages are cut */
+#endif
+
+/*
+ * Any thread may log, the message is copied to a lock-free ring and the
+ * shell writes it from its own thread when get_char has no input: the
+ * half-typed line is cleared, the logs are written and the prompt and the
+ * line are drawn again. A producer never waits, when the ring is full the
+ * message is dropped and counted.
+ */
+int finsh_log_write(const char *buf, uint32_t size);
+int finsh_log_printf(const char *fmt, ...) FINSH_PRINTF_FORMAT(1, 2);
+void finsh_log_drain(void);
+void finsh_log_counters(uint32_t *written, uint32_t *dropped, uint32_t *truncated);
+
+#endif /* FINSH_USING_LOG */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of session record and replay
+ */
+
+#include "msh_replay.h"
+
+#ifdef FINSH_USING_REPLAY
+
+static struct {
+    finsh_record_write_t write;
+    int (*get_char)(void);
+    finsh_output_t output;
+    uint32_t tick; /* of the last record */
+} record;
+
+static struct {
+    struct finsh_replay *replay;
+    uint32_t tick_per_second; /* of the recording */
+    uint32_t start;           /* tick the replay started */
+    uint32_t due;             /* recorded time of the next input, in ticks of the recording */
+
+    uint32_t in_pos;  /* next record to look at for input */
+    uint32_t out_pos; /* current output record */
+    uint32_t out_left;
+    uint32_t out_seen; /* output bytes compared so far */
+    uint8_t last;      /* the previous input byte */
+} play;
+
+static void record_varint(uint8_t *buf, uint32_t *size, uint32_t value) {
+    while (value >= 0x80) {
+        buf[(*size)++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    buf[(*size)++] = value;
+}
+
+static void record_put(uint8_t type, const void *buf, uint32_t size) {
+    uint8_t head[11];
+    uint32_t length = 0, now = finsh_get_tick();
+
+    head[length++] = type;
+    record_varint(head, &length, now - record.tick);
+    record_varint(head, &length, size);
+    record.tick = now;
+
+    record.write(head, length);
+    record.write(buf, size);
+}
+
+static int record_getchar(void) {
+    int ch = record.get_char();
+
+    if (ch >= 0) {
+        uint8_t byte = ch;
+        record_put(FINSH_REPLAY_INPUT, &byte, 1);
+    }
+
+    return ch;
+}
+
+static void record_output(const char *buf, uint32_t size) {
+    record_put(FINSH_REPLAY_OUTPUT, buf, size);
+    record.output(buf, size);
+}
+
+/**
+ * @ingroup finsh
+ *
+ * This function starts recording the input and the output of the shell.
+ * Start it right after finsh_system_init() for a recording which replays
+ * byte-identical, the state of the line editor and the history is not
+ * part of it.
+ *
+ * @param write the sink of the recording, e.g. a file
+ *
+ * @return 0 on OK, -1 when the shell is not initialized or already recording
+ */
+int finsh_record_start(finsh_record_write_t write) {
+    uint8_t header[8] = {'F', 'S', 'R', FINSH_REPLAY_VERSION};
+    uint32_t hz = FINSH_TICK_PER_SECOND;
+
+    if (finsh_shell_current == NULL || write == NULL || record.write) return -1;
+
+    header[4] = hz;
+    header[5] = hz >> 8;
+    header[6] = hz >> 16;
+    header[7] = hz >> 24;
+    write(header, sizeof(header));
+
+    record.write = write;
+    record.get_char = finsh_shell_current->get_char;
+    record.output = finsh_shell_current->output;
+    record.tick = finsh_get_tick();
+    finsh_shell_current->get_char = record_getchar;
+    finsh_shell_current->output = record_output;
+
+    return 0;
+}
+
+void finsh_record_stop(void) {
+    if (record.write == NULL) return;
+
+    finsh_shell_current->get_char = record.get_char;
+    finsh_shell_current->output = record.output;
+    record.write = NULL;
+}
+
+/* reads a record header at pos, returns the offset of its bytes or 0 when it is broken */
+static uint32_t play_record(uint32_t pos, uint8_t *type, uint32_t *delta, uint32_t *length) {
+    const struct finsh_replay *replay = play.replay;
+    uint32_t *values[2] = {delta, length};
+    int i, shift;
+
+    if (pos >= replay->size) return 0;
+    *type = replay->data[pos++];
+
+    for (i = 0; i < 2; i++) {
+        *values[i] = 0;
+        for (shift = 0; pos < replay->size && shift < 32; shift += 7) {
+            uint8_t byte = replay->data[pos++];
+
+            *values[i] |= (uint32_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) break;
+        }
+    }
+
+    return pos + *length <= replay->size ? pos : 0;
+}
+
+static int play_getchar(void) {
+    struct finsh_replay *replay = play.replay;
+    uint32_t pos, delta, length;
+    uint8_t type, ch;
+
+    /* the next input record, the time of the output records counts too */
+    while ((pos = play_record(play.in_pos, &type, &delta, &length)) != 0) {
+        if (type == FINSH_REPLAY_INPUT && length == 1) break;
+        play.due += delta;
+        play.in_pos = pos + length;
+    }
+    if (pos == 0) return FINSH_GETCHAR_EOF;
+
+    if (replay->realtime) {
+        uint64_t due = (uint64_t)(play.due + delta) * FINSH_TICK_PER_SECOND / play.tick_per_second;
+
+        if (finsh_get_tick() - play.start < due) return -1;
+    }
+
+    play.due += delta;
+    play.in_pos = pos + length;
+    ch = replay->data[pos];
+
+    replay->keys++;
+    if (ch == '\r' || (ch == '\n' && play.last != '\r')) replay->commands++;
+    play.last = ch;
+
+    return ch;
+}
+
+/* compares the output with the recorded one */
+static void play_output(const char *buf, uint32_t size) {
+    struct finsh_replay *replay = play.replay;
+    uint32_t delta, length;
+    uint8_t type;
+
+    while (size && replay->match) {
+        if (play.out_left == 0) {
+            uint32_t pos = play_record(play.out_pos, &type, &delta, &length);
+
+            if (pos == 0) {
+                /* more output than recorded */
+                replay->match = 0;
+                replay->mismatch = play.out_seen;
+                return;
+            }
+            play.out_pos = pos;
+            play.out_left = type == FINSH_REPLAY_OUTPUT ? length : 0;
+            if (type != FINSH_REPLAY_OUTPUT) play.out_pos += length;
+            continue;
+        }
+
+        if (replay->data[play.out_pos] != (uint8_t)*buf) {
+            replay->match = 0;
+            replay->mismatch = play.out_seen;
+            return;
+        }
+        play.out_pos++;
+        play.out_left--;
+        play.out_seen++;
+        buf++;
+        size--;
+    }
+}
+
+/**
+ * @ingroup finsh
+ *
+ * This function runs the shell on a recording: the recorded input is fed
+ * through get_char and the output is compared with the recorded output.
+ * It runs a shell initialized with cfg, whose get_char and output are not
+ * used, and returns when the input is used up. The shell which was current
+ * before and its command table are current again afterwards, so cfg needs
+ * an arena of its own when there is one.
+ *
+ * @return 0 when the output is byte-identical, -1 otherwise
+ */
+int finsh_replay(finsh_shell_cfg_t *cfg, struct finsh_replay *replay) {
+    finsh_shell_cfg_t replay_cfg = *cfg;
+    struct finsh_shell *previous = finsh_shell_current;
+    struct finsh_syscall *previous_begin = _syscall_table_begin, *previous_end = _syscall_table_end;
+    uint8_t previous_sorted = _syscall_table_sorted;
+    const uint8_t *data = replay->data;
+    uint32_t delta, length;
+    uint8_t type;
+
+    replay->keys = replay->commands = replay->ticks = replay->mismatch = 0;
+    replay->match = 0;
+    if (replay->size < 8 || data[0] != 'F' || data[1] != 'S' || data[2] != 'R' || data[3] != FINSH_REPLAY_VERSION) return -1;
+    /* the default arena holds the current shell */
+    if (previous && cfg->arena == NULL) return -1;
+
+    FINSH_MEMSET(&play, 0, sizeof(play));
+    play.replay = replay;
+    play.tick_per_second = data[4] | (data[5] << 8) | (data[6] << 16) | ((uint32_t)data[7] << 24);
+    if (play.tick_per_second == 0) return -1;
+    play.in_pos = play.out_pos = 8;
+    replay->match = 1;
+
+    replay_cfg.get_char = play_getchar;
+    replay_cfg.output = play_output;
+    if (finsh_system_init(&replay_cfg) != 0) {
+        finsh_shell_current = previous;
+        replay->match = 0;
+        return -1;
+    }
+
+    play.start = finsh_get_tick();
+    finsh_run();
+    replay->ticks = finsh_get_tick() - play.start;
+
+    finsh_shell_current = previous;
+    _syscall_table_begin = previous_begin;
+    _syscall_table_end = previous_end;
+    _syscall_table_sorted = previous_sorted;
+
+    /* the recorded output must be used up as well */
+    while (replay->match && play.out_left == 0) {
+        uint32_t pos = play_record(play.out_pos, &type, &delta, &length);
+
+        if (pos == 0 || (type == FINSH_REPLAY_OUTPUT && length)) break;
+        play.out_pos = pos + length;
+    }
+    if (replay->match && (play.out_left || play.out_pos < replay->size)) {
+        replay->match = 0;
+        replay->mismatch = play.out_seen;
+    }
+
+    return replay->match ? 0 : -1;
+}
+
+#endif /* FINSH_USING_REPLAY */
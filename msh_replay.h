@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of session record and replay
+ */
+
+#ifndef __MSH_REPLAY_H__
+#define __MSH_REPLAY_H__
+
+#include "shell.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef FINSH_USING_REPLAY
+
+/*
+ * A recording is a header followed by records:
+ *
+ *     header: 'F' 'S' 'R' version(1) tick_per_second(4, little endian)
+ *     record: type(1) delta_ticks(varint) length(varint) bytes
+ *
+ * The type is 'I' for bytes returned by get_char and 'O' for bytes written
+ * to the output, the delta is the time since the previous record.
+ */
+#define FINSH_REPLAY_VERSION 1
+#define FINSH_REPLAY_INPUT   'I'
+#define FINSH_REPLAY_OUTPUT  'O'
+
+typedef void (*finsh_record_write_t)(const void *buf, uint32_t size);
+
+struct finsh_replay {
+    const uint8_t *data; /* the recording */
+    uint32_t size;
+    uint8_t realtime; /* feed the input at the recorded pace, else as fast as possible */
+
+    /* results */
+    uint32_t keys;     /* input bytes fed */
+    uint32_t commands; /* lines entered */
+    uint32_t ticks;    /* time taken, in the ticks of the shell */
+    uint32_t mismatch; /* offset of the first differing output byte */
+    uint8_t match;     /* the output is byte-identical */
+};
+
+int finsh_record_start(finsh_record_write_t write);
+void finsh_record_stop(void);
+int finsh_replay(finsh_shell_cfg_t *cfg, struct finsh_replay *replay);
+
+#endif /* FINSH_USING_REPLAY */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of binary rpc mode
+ */
+
+#include "msh_rpc.h"
+#include "msh_stats.h"
+#include "msh_trace.h"
+#include "shell.h"
+
+#if defined(FINSH_USING_RPC) || defined(FINSH_USING_BULK)
+
+static const uint16_t crc16_table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+/* crc16 CCITT, one nibble at a time */
+uint16_t finsh_crc16(uint16_t crc, const uint8_t *buf, uint32_t size) {
+    while (size--) {
+        crc = (crc << 4) ^ crc16_table[(crc >> 12) ^ (*buf >> 4)];
+        crc = (crc << 4) ^ crc16_table[(crc >> 12) ^ (*buf & 0x0F)];
+        buf++;
+    }
+
+    return crc;
+}
+
+#endif
+
+#ifdef FINSH_USING_RPC
+
+typedef int (*cmd_function_t)(int argc, char **argv);
+
+enum rpc_stat {
+    RPC_WAIT_SOF,
+    RPC_WAIT_HEADER,
+    RPC_WAIT_PAYLOAD,
+};
+
+static struct {
+    enum rpc_stat stat;
+    uint16_t pos;
+    uint8_t header[FINSH_RPC_HEADER_SIZE - 1]; /* header without sof */
+    uint8_t rx[FINSH_RPC_FRAME_MAX + 2];       /* payload and crc */
+    uint16_t rx_len;
+
+    uint8_t in_call;
+    uint16_t seq; /* seq of the running call */
+    uint16_t tx_len;
+    uint8_t tx[FINSH_RPC_FRAME_MAX];
+
+    finsh_output_t link; /* the output of the shell before rpc mode */
+} rpc;
+
+static void rpc_send(uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t len) {
+    uint8_t header[FINSH_RPC_HEADER_SIZE];
+    uint8_t crc_le[2];
+    uint16_t crc;
+
+    header[0] = FINSH_RPC_SOF;
+    header[1] = type;
+    header[2] = seq & 0xFF;
+    header[3] = seq >> 8;
+    header[4] = len & 0xFF;
+    header[5] = len >> 8;
+
+    crc = finsh_crc16(0xFFFF, &header[1], FINSH_RPC_HEADER_SIZE - 1);
+    crc = finsh_crc16(crc, payload, len);
+    crc_le[0] = crc & 0xFF;
+    crc_le[1] = crc >> 8;
+
+    rpc.link((const char *)header, sizeof(header));
+    if (len) rpc.link((const char *)payload, len);
+    rpc.link((const char *)crc_le, sizeof(crc_le));
+}
+
+static void rpc_send_result(uint16_t seq, int32_t ret) {
+    uint8_t payload[4];
+
+    payload[0] = ret & 0xFF;
+    payload[1] = (ret >> 8) & 0xFF;
+    payload[2] = (ret >> 16) & 0xFF;
+    payload[3] = (ret >> 24) & 0xFF;
+    rpc_send(FINSH_RPC_RESULT, seq, payload, sizeof(payload));
+}
+
+static void rpc_send_error(uint16_t seq, uint8_t code) { rpc_send(FINSH_RPC_ERROR, seq, &code, 1); }
+
+static void rpc_flush(void) {
+    if (rpc.tx_len == 0) return;
+
+    rpc_send(FINSH_RPC_OUTPUT, rpc.seq, rpc.tx, rpc.tx_len);
+    rpc.tx_len = 0;
+}
+
+/* shell output while in rpc mode, output outside of a call goes out at once with seq 0xFFFF */
+static void rpc_capture(const char *buf, uint32_t size) {
+    while (size) {
+        uint32_t count = FINSH_RPC_FRAME_MAX - rpc.tx_len;
+
+        if (count > size) count = size;
+        FINSH_MEMCPY(&rpc.tx[rpc.tx_len], buf, count);
+        rpc.tx_len += count;
+        buf += count;
+        size -= count;
+
+        if (rpc.tx_len == FINSH_RPC_FRAME_MAX) rpc_flush();
+    }
+
+    if (!rpc.in_call) {
+        rpc.seq = 0xFFFF;
+        rpc_flush();
+    }
+}
+
+static void rpc_send_name(uint16_t seq, uint16_t id, const char *name) {
+    uint8_t payload[FINSH_RPC_FRAME_MAX];
+    uint32_t len = FINSH_STRLEN(name);
+
+    if (len > sizeof(payload) - 2) len = sizeof(payload) - 2;
+    payload[0] = id & 0xFF;
+    payload[1] = id >> 8;
+    FINSH_MEMCPY(&payload[2], name, len);
+    rpc_send(FINSH_RPC_NAME, seq, payload, len + 2);
+}
+
+/* the table commands by their index, then the registered ones by their id */
+static void rpc_hello(uint16_t seq) {
+    struct finsh_syscall *index;
+    uint16_t id = 0;
+
+    for (index = _syscall_table_begin; index < _syscall_table_end; FINSH_NEXT_SYSCALL(index)) rpc_send_name(seq, id++, index->name);
+#ifdef FINSH_USING_REGISTRY
+    {
+        int i;
+
+        for (i = 0; i < msh_cmd_count(); i++) rpc_send_name(seq, msh_cmd_at(i)->id, msh_cmd_at(i)->name);
+        id += msh_cmd_count();
+    }
+#endif
+
+    rpc_send_result(seq, id);
+}
+
+static void rpc_call(uint16_t seq, uint8_t *payload, uint16_t len) {
+    struct finsh_syscall *index;
+#ifdef FINSH_USING_REGISTRY
+    struct msh_cmd *cmd;
+#endif
+    char **argv;
+    const char *name;
+    uint16_t id, pos;
+#ifdef FINSH_USING_STATS
+    uint32_t start;
+#endif
+    uint8_t session;
+    int argc, i;
+    int ret;
+
+    if (len < 3 || payload[2] + 1 > finsh_shell_current->arg_max) {
+        rpc_send_error(seq, FINSH_RPC_ERR_ARGS);
+        return;
+    }
+    if (finsh_shell_current->exec_depth >= finsh_shell_current->exec_depth_max) {
+        rpc_send_error(seq, FINSH_RPC_ERR_DEPTH);
+        return;
+    }
+
+    /* a registered command by its id, a table command by its index */
+    id = payload[0] | (payload[1] << 8);
+    index = _syscall_table_end;
+#ifdef FINSH_USING_REGISTRY
+    cmd = NULL;
+    if (id >= MSH_CMD_ID_BASE)
+        cmd = msh_cmd_by_id(id);
+    else
+#endif
+        for (index = _syscall_table_begin; index < _syscall_table_end && id; FINSH_NEXT_SYSCALL(index)) id--;
+#ifdef FINSH_USING_REGISTRY
+    if (index >= _syscall_table_end && cmd == NULL) {
+#else
+    if (index >= _syscall_table_end) {
+#endif
+        rpc_send_error(seq, FINSH_RPC_ERR_ID);
+        return;
+    }
+#ifdef FINSH_USING_REGISTRY
+    name = cmd ? cmd->name : index->name;
+#else
+    name = index->name;
+#endif
+
+    /* the arguments are used in place, the call takes the argv slots of one level of msh_exec() */
+    argc = payload[2] + 1;
+    argv = &finsh_shell_current->argv[finsh_shell_current->exec_depth * finsh_shell_current->arg_max];
+    argv[0] = (char *)name;
+    pos = 3;
+    for (i = 1; i < argc; i++) {
+        argv[i] = (char *)&payload[pos];
+        while (pos < len && payload[pos] != '\0') pos++;
+        if (pos >= len) {
+            rpc_send_error(seq, FINSH_RPC_ERR_ARGS);
+            return;
+        }
+        pos++;
+    }
+
+#ifdef FINSH_USING_CANCEL
+    finsh_cancel_reset();
+#endif
+    rpc.seq = seq;
+    rpc.in_call = 1;
+    finsh_shell_current->exec_depth++;
+    session = finsh_set_session(FINSH_SESSION_RPC);
+#ifdef FINSH_USING_STATS
+    start = finsh_get_clock();
+#endif
+    FINSH_TRACE_BEGIN(name);
+#ifdef FINSH_USING_REGISTRY
+    if (cmd)
+        ret = cmd->func(cmd->ctx, argc, argv);
+    else
+#endif
+        ret = ((cmd_function_t)(void (*)(void))index->func)(argc, argv);
+    FINSH_TRACE_END(name);
+#ifdef FINSH_USING_STATS
+    msh_stats_record(name, finsh_get_clock() - start, ret);
+#endif
+    rpc_flush();
+    finsh_set_session(session);
+    finsh_shell_current->exec_depth--;
+    rpc.in_call = 0;
+#ifdef FINSH_USING_CANCEL
+    finsh_cancel_reset();
+#endif
+
+    rpc_send_result(seq, ret);
+}
+
+static void rpc_exit(uint16_t seq) {
+    rpc_send_result(seq, 0);
+
+    finsh_set_output(rpc.link);
+    finsh_set_input_hook(NULL);
+    rpc.link = NULL;
+    FINSH_PUTS(FINSH_PROMPT);
+}
+
+static void rpc_handle(void) {
+    uint8_t type = rpc.header[0];
+    uint16_t seq = rpc.header[1] | (rpc.header[2] << 8);
+    uint16_t crc;
+
+    crc = finsh_crc16(0xFFFF, rpc.header, sizeof(rpc.header));
+    crc = finsh_crc16(crc, rpc.rx, rpc.rx_len);
+    if (crc != (rpc.rx[rpc.rx_len] | (rpc.rx[rpc.rx_len + 1] << 8))) {
+        rpc_send_error(seq, FINSH_RPC_ERR_CRC);
+        return;
+    }
+
+    switch (type) {
+        case FINSH_RPC_HELLO:
+            rpc_hello(seq);
+            break;
+        case FINSH_RPC_CALL:
+            rpc_call(seq, rpc.rx, rpc.rx_len);
+            break;
+        case FINSH_RPC_EXIT:
+            rpc_exit(seq);
+            break;
+        default:
+            rpc_send_error(seq, FINSH_RPC_ERR_TYPE);
+            break;
+    }
+}
+
+static void rpc_input(uint8_t ch) {
+    switch (rpc.stat) {
+        case RPC_WAIT_SOF:
+            if (ch == FINSH_RPC_SOF) {
+                rpc.stat = RPC_WAIT_HEADER;
+                rpc.pos = 0;
+            }
+            break;
+
+        case RPC_WAIT_HEADER:
+            rpc.header[rpc.pos++] = ch;
+            if (rpc.pos < sizeof(rpc.header)) break;
+
+            rpc.rx_len = rpc.header[3] | (rpc.header[4] << 8);
+            if (rpc.rx_len > FINSH_RPC_FRAME_MAX) {
+                rpc_send_error(rpc.header[1] | (rpc.header[2] << 8), FINSH_RPC_ERR_SIZE);
+                rpc.stat = RPC_WAIT_SOF;
+                break;
+            }
+            rpc.stat = RPC_WAIT_PAYLOAD;
+            rpc.pos = 0;
+            break;
+
+        case RPC_WAIT_PAYLOAD:
+            rpc.rx[rpc.pos++] = ch;
+            if (rpc.pos < rpc.rx_len + 2) break;
+
+            rpc.stat = RPC_WAIT_SOF;
+            rpc_handle();
+            break;
+    }
+}
+
+static int msh_rpc(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+
+    /* already in rpc mode */
+    if (rpc.link) return -1;
+
+    FINSH_MEMSET(&rpc, 0, sizeof(rpc));
+    rpc.link = finsh_set_output(rpc_capture);
+    finsh_set_input_hook(rpc_input);
+
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(msh_rpc, rpc, Switch the console to binary rpc mode.);
+
+#endif /* FINSH_USING_RPC */
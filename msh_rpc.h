@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of binary rpc mode
+ */
+
+#ifndef __MSH_RPC_H__
+#define __MSH_RPC_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Frame layout, multi-byte fields are little endian:
+ *
+ *   | sof | type | seq (2) | len (2) | payload (len) | crc16 (2) |
+ *
+ * The crc16 (CCITT, init 0xFFFF) covers type to the end of the payload.
+ * Requests and responses carry the same seq, so a client may send many
+ * requests without waiting and match the responses by seq.
+ *
+ * FINSH_RPC_HELLO  request:  empty
+ *                  response: one FINSH_RPC_NAME per command, then FINSH_RPC_RESULT
+ * FINSH_RPC_CALL   request:  id (2) | argc (1) | argc NUL terminated arguments
+ *                  response: FINSH_RPC_OUTPUT frames, then FINSH_RPC_RESULT
+ * FINSH_RPC_EXIT   request:  empty, back to text mode after FINSH_RPC_RESULT
+ *
+ * FINSH_RPC_NAME   id (2) | name, the id is the index in the command table or,
+ *                  from MSH_CMD_ID_BASE, the id of a registered command. Ids
+ *                  do not change when other commands are registered.
+ * FINSH_RPC_OUTPUT captured output of the command
+ * FINSH_RPC_RESULT return code (4), the number of commands for FINSH_RPC_HELLO
+ * FINSH_RPC_ERROR  error code (1), FINSH_RPC_ERR_xxx
+ */
+#define FINSH_RPC_SOF 0xA5
+
+#define FINSH_RPC_HELLO  0x01
+#define FINSH_RPC_CALL   0x02
+#define FINSH_RPC_EXIT   0x03
+#define FINSH_RPC_NAME   0x81
+#define FINSH_RPC_OUTPUT 0x82
+#define FINSH_RPC_RESULT 0x83
+#define FINSH_RPC_ERROR  0x8F
+
+#define FINSH_RPC_ERR_CRC     1 /* corrupted frame */
+#define FINSH_RPC_ERR_SIZE    2 /* payload larger than FINSH_RPC_FRAME_MAX */
+#define FINSH_RPC_ERR_TYPE    3 /* unknown request */
+#define FINSH_RPC_ERR_ID      4 /* no command with this id */
+#define FINSH_RPC_ERR_ARGS    5 /* malformed arguments, or more than the arg_max of the shell */
+#define FINSH_RPC_ERR_DEPTH   6 /* every level of msh_exec() is running */
+
+#define FINSH_RPC_HEADER_SIZE 6 /* sof, type, seq, len */
+
+#ifdef FINSH_USING_RPC
+
+#ifndef FINSH_RPC_FRAME_MAX
+#define FINSH_RPC_FRAME_MAX 256
+#endif
+
+#endif /* FINSH_USING_RPC */
+
+/* shared with the bulk transfer mode */
+#if defined(FINSH_USING_RPC) || defined(FINSH_USING_BULK)
+uint16_t finsh_crc16(uint16_t crc, const uint8_t *buf, uint32_t size);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,477 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of shared memory channel
+ */
+
+#include "msh_shm.h"
+
+#if defined(FINSH_USING_SHM) && defined(__linux__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <signal.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "msh.h"
+#include "msh_trace.h"
+#include "shell.h"
+
+#define SHM_MAGIC   0x46534D32 /* "FSM2" */
+#define SHM_TX_SIZE 256
+#define SHM_SLICE_MS 100 /* a waiting client checks the shell is alive this often */
+
+#define SHM_REQ_LINE   1 /* value: length of the command line */
+#define SHM_RSP_OUTPUT 2 /* value: length of the output */
+#define SHM_RSP_RESULT 3 /* value: return code of the command */
+
+/* a record and its payload are published at once, a reader never sees part of one */
+struct shm_record {
+    uint32_t type;
+    int32_t value;
+    uint32_t id; /* of the request, the responses to an abandoned request are skipped */
+};
+
+struct shm_ring {
+    _Atomic uint32_t head; /* free running, advanced by the producer */
+    _Atomic uint32_t tail; /* free running, advanced by the consumer */
+    _Atomic uint32_t head_waiters;
+    _Atomic uint32_t tail_waiters;
+    uint8_t data[FINSH_SHM_RING_SIZE];
+};
+
+struct finsh_shm {
+    _Atomic uint32_t magic;
+    _Atomic uint32_t server_pid;
+    _Atomic uint32_t lock; /* pid of the client holding it, 0 when free */
+    _Atomic uint32_t lock_waiters;
+    _Atomic uint32_t next_id;
+    struct shm_ring req;
+    struct shm_ring rsp;
+};
+
+static int futex_wait(_Atomic uint32_t *addr, uint32_t val, const struct timespec *timeout) {
+    return syscall(SYS_futex, addr, FUTEX_WAIT, val, timeout, NULL, 0);
+}
+
+static void futex_wake(_Atomic uint32_t *addr) { syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0); }
+
+/* sleep until *addr is no longer val, the waiters count tells the other side to wake us */
+static int shm_sleep(_Atomic uint32_t *addr, _Atomic uint32_t *waiters, uint32_t val, const struct timespec *timeout) {
+    int result = 0;
+
+    atomic_fetch_add(waiters, 1);
+    if (atomic_load(addr) == val) result = futex_wait(addr, val, timeout);
+    atomic_fetch_sub(waiters, 1);
+
+    return (result < 0 && errno == ETIMEDOUT) ? -1 : 0;
+}
+
+static int shm_alive(uint32_t pid) { return pid != 0 && (kill((pid_t)pid, 0) == 0 || errno == EPERM); }
+
+static int64_t shm_now_ms(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void ms_to_timespec(int64_t ms, struct timespec *ts) {
+    ts->tv_sec = ms / 1000;
+    ts->tv_nsec = (ms % 1000) * 1000000L;
+}
+
+static uint32_t ring_used(struct shm_ring *ring) {
+    return atomic_load_explicit(&ring->head, memory_order_acquire) - atomic_load_explicit(&ring->tail, memory_order_acquire);
+}
+
+/* copy in at head without publishing it */
+static void ring_copy_in(struct shm_ring *ring, uint32_t head, const void *buf, uint32_t size) {
+    uint32_t offset = head & (FINSH_SHM_RING_SIZE - 1);
+    uint32_t count = FINSH_SHM_RING_SIZE - offset < size ? FINSH_SHM_RING_SIZE - offset : size;
+
+    memcpy(&ring->data[offset], buf, count);
+    memcpy(ring->data, (const uint8_t *)buf + count, size - count);
+}
+
+/* write a record and its payload as one, the caller made sure there is room, see ring_room() */
+static void ring_put(struct shm_ring *ring, const struct shm_record *record, const void *buf, uint32_t size) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+    ring_copy_in(ring, head, record, sizeof(*record));
+    if (size) ring_copy_in(ring, head + sizeof(*record), buf, size);
+    atomic_store_explicit(&ring->head, head + sizeof(*record) + size, memory_order_seq_cst);
+    if (atomic_load(&ring->head_waiters)) futex_wake(&ring->head);
+}
+
+/* wait until size bytes are free, -1 when the timeout ends first */
+static int ring_room(struct shm_ring *ring, uint32_t size, const struct timespec *timeout) {
+    for (;;) {
+        uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+        if (FINSH_SHM_RING_SIZE - (atomic_load_explicit(&ring->head, memory_order_relaxed) - tail) >= size) return 0;
+        if (shm_sleep(&ring->tail, &ring->tail_waiters, tail, timeout) != 0) return -1;
+    }
+}
+
+/* read size bytes which are in the ring, buf NULL skips them */
+static void ring_get(struct shm_ring *ring, void *buf, uint32_t size) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t offset = tail & (FINSH_SHM_RING_SIZE - 1);
+    uint32_t count = FINSH_SHM_RING_SIZE - offset < size ? FINSH_SHM_RING_SIZE - offset : size;
+
+    if (buf) {
+        memcpy(buf, &ring->data[offset], count);
+        memcpy((uint8_t *)buf + count, ring->data, size - count);
+    }
+    atomic_store_explicit(&ring->tail, tail + size, memory_order_seq_cst);
+    if (atomic_load(&ring->tail_waiters)) futex_wake(&ring->tail);
+}
+
+static struct finsh_shm *shm_map(const char *name, int flags) {
+    struct finsh_shm *shm;
+    int fd;
+
+    fd = shm_open(name, flags, 0600);
+    if (fd < 0) return NULL;
+
+    if ((flags & O_CREAT) && ftruncate(fd, sizeof(struct finsh_shm)) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    shm = mmap(NULL, sizeof(struct finsh_shm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    return shm == MAP_FAILED ? NULL : shm;
+}
+
+#ifndef FINSH_SHM_CLIENT_ONLY
+/* the shell never waits longer than this for a client to read its output */
+static const struct timespec shm_timeout = {FINSH_SHM_TIMEOUT_MS / 1000, (FINSH_SHM_TIMEOUT_MS % 1000) * 1000000L};
+
+static struct {
+    struct finsh_shm *shm;
+    char name[64];
+    uint32_t id;     /* of the running request */
+    uint8_t stalled; /* the client stopped reading, drop the rest of the output */
+    uint32_t tx_len;
+    char tx[SHM_TX_SIZE];
+} server;
+
+/*
+ * Output is only written while the room of the result stays free, so the
+ * result is always delivered, even after the client stopped reading.
+ */
+static void shm_respond(uint32_t type, int32_t value, const void *buf, uint32_t size) {
+    struct shm_record record = {type, value, server.id};
+    uint32_t reserve = type == SHM_RSP_RESULT ? 0 : sizeof(record);
+
+    if (type != SHM_RSP_RESULT && server.stalled) return;
+
+    if (ring_room(&server.shm->rsp, sizeof(record) + size + reserve, &shm_timeout) != 0) {
+        server.stalled = 1;
+        return;
+    }
+    ring_put(&server.shm->rsp, &record, buf, size);
+}
+
+static void shm_flush(void) {
+    if (server.tx_len == 0) return;
+
+    shm_respond(SHM_RSP_OUTPUT, server.tx_len, server.tx, server.tx_len);
+    server.tx_len = 0;
+}
+
+static void shm_capture(const char *buf, uint32_t size) {
+    while (size) {
+        uint32_t count = SHM_TX_SIZE - server.tx_len;
+
+        if (count > size) count = size;
+        memcpy(&server.tx[server.tx_len], buf, count);
+        server.tx_len += count;
+        buf += count;
+        size -= count;
+
+        if (server.tx_len == SHM_TX_SIZE) shm_flush();
+    }
+}
+
+/**
+ * @ingroup msh
+ *
+ * This function creates the shared memory channel, e.g. "/finsh". A
+ * channel in use by another shell is never taken over, one left by a shell
+ * which died is created again.
+ *
+ * @return 0 on OK, -1 on error
+ */
+int msh_shm_init(const char *name) {
+    if (server.shm) return -1;
+
+    server.shm = shm_map(name, O_CREAT | O_EXCL | O_RDWR);
+    if (server.shm == NULL && errno == EEXIST) {
+        struct finsh_shm *old = shm_map(name, O_RDWR);
+        int stale = old && atomic_load(&old->magic) == SHM_MAGIC && !shm_alive(atomic_load(&old->server_pid));
+
+        if (old) munmap(old, sizeof(struct finsh_shm));
+        if (!stale) return -1;
+
+        shm_unlink(name);
+        server.shm = shm_map(name, O_CREAT | O_EXCL | O_RDWR);
+    }
+    if (server.shm == NULL) return -1;
+
+    memset(server.shm, 0, sizeof(struct finsh_shm));
+    strncpy(server.name, name, sizeof(server.name) - 1);
+    atomic_store(&server.shm->server_pid, (uint32_t)getpid());
+    atomic_store(&server.shm->magic, SHM_MAGIC);
+
+    return 0;
+}
+
+void msh_shm_deinit(void) {
+    if (server.shm == NULL) return;
+
+    atomic_store(&server.shm->server_pid, 0);
+    munmap(server.shm, sizeof(struct finsh_shm));
+    shm_unlink(server.name);
+    server.shm = NULL;
+}
+
+/**
+ * @ingroup msh
+ *
+ * This function runs the command lines waiting in the channel. finsh_run()
+ * calls it whenever get_char has no input.
+ *
+ * @return the number of commands executed
+ */
+int msh_shm_poll(void) {
+    struct shm_ring *req;
+    struct shm_record record;
+    char *line;
+    finsh_output_t output;
+    int count = 0;
+    uint8_t session;
+    int ret;
+
+    if (server.shm == NULL) return 0;
+
+    /* copied out of the ring, msh_exec() splits it in place */
+    line = finsh_shell_current->shm_line;
+    req = &server.shm->req;
+    while (ring_used(req) >= sizeof(record)) {
+        ring_get(req, &record, sizeof(record));
+        server.id = record.id;
+        server.stalled = 0;
+
+        if (record.type != SHM_REQ_LINE || record.value < 0 || (uint32_t)record.value > ring_used(req)) {
+            /* the client broke the protocol, drop everything it sent */
+            ring_get(req, NULL, ring_used(req));
+            shm_respond(SHM_RSP_RESULT, -1, NULL, 0);
+            break;
+        }
+
+        if (record.value > finsh_shell_current->line_size) {
+            ring_get(req, NULL, record.value);
+            shm_respond(SHM_RSP_RESULT, -1, NULL, 0);
+            continue;
+        }
+
+        ring_get(req, line, record.value);
+        line[record.value] = '\0';
+
+        output = finsh_set_output(shm_capture);
+        session = finsh_set_session(FINSH_SESSION_SHM);
+        ret = msh_exec(line, record.value);
+        shm_flush();
+        finsh_set_session(session);
+        finsh_set_output(output);
+
+        shm_respond(SHM_RSP_RESULT, ret, NULL, 0);
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * @ingroup msh
+ *
+ * This function sleeps until a command line arrives, for main loops which
+ * would otherwise block in get_char.
+ *
+ * @param timeout_ms the maximum time to sleep, -1 to wait forever
+ *
+ * @return 0 when a command is waiting, -1 on timeout
+ */
+int msh_shm_wait(int timeout_ms) {
+    struct timespec timeout;
+    struct shm_ring *ring;
+    uint32_t head;
+
+    if (server.shm == NULL) return -1;
+
+    ring = &server.shm->req;
+    ms_to_timespec(timeout_ms, &timeout);
+
+    head = atomic_load(&ring->head);
+    if (head != atomic_load(&ring->tail)) return 0;
+
+    return shm_sleep(&ring->head, &ring->head_waiters, head, timeout_ms < 0 ? NULL : &timeout);
+}
+#endif /* FINSH_SHM_CLIENT_ONLY */
+
+/**
+ * @ingroup msh
+ *
+ * This function attaches a client to the channel created by msh_shm_init().
+ *
+ * @return the channel, NULL on error
+ */
+struct finsh_shm *msh_shm_open(const char *name) {
+    struct finsh_shm *shm = shm_map(name, O_RDWR);
+
+    if (shm && atomic_load(&shm->magic) != SHM_MAGIC) {
+        munmap(shm, sizeof(struct finsh_shm));
+        return NULL;
+    }
+
+    return shm;
+}
+
+void msh_shm_close(struct finsh_shm *shm) { munmap(shm, sizeof(struct finsh_shm)); }
+
+/* the lock holds the pid of its owner, a lock left by a client which died is taken over */
+static void shm_lock(struct finsh_shm *shm) {
+    uint32_t self = (uint32_t)getpid();
+    uint32_t owner = 0;
+    struct timespec slice;
+
+    ms_to_timespec(SHM_SLICE_MS, &slice);
+    while (!atomic_compare_exchange_strong(&shm->lock, &owner, self)) {
+        if (!shm_alive(owner)) {
+            if (atomic_compare_exchange_strong(&shm->lock, &owner, self)) break;
+            continue;
+        }
+        shm_sleep(&shm->lock, &shm->lock_waiters, owner, &slice);
+        owner = 0;
+    }
+}
+
+static void shm_unlock(struct finsh_shm *shm) {
+    atomic_store(&shm->lock, 0);
+    if (atomic_load(&shm->lock_waiters)) futex_wake(&shm->lock);
+}
+
+/* wait until size bytes arrive, -1 at the deadline or when the shell is gone */
+static int shm_wait_data(struct finsh_shm *shm, uint32_t size, int64_t deadline) {
+    struct shm_ring *ring = &shm->rsp;
+    struct timespec slice;
+
+    for (;;) {
+        uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        int64_t wait = SHM_SLICE_MS;
+
+        if (head - atomic_load_explicit(&ring->tail, memory_order_relaxed) >= size) return 0;
+        if (!shm_alive(atomic_load(&shm->server_pid))) return ring_used(ring) >= size ? 0 : -1;
+        if (deadline >= 0) {
+            wait = deadline - shm_now_ms();
+            if (wait <= 0) return -1;
+            if (wait > SHM_SLICE_MS) wait = SHM_SLICE_MS;
+        }
+
+        ms_to_timespec(wait, &slice);
+        shm_sleep(&ring->head, &ring->head_waiters, head, &slice);
+    }
+}
+
+/* wait until the request fits, -1 at the deadline or when the shell is gone */
+static int shm_wait_room(struct finsh_shm *shm, uint32_t size, int64_t deadline) {
+    struct timespec slice;
+
+    ms_to_timespec(SHM_SLICE_MS, &slice);
+    while (ring_room(&shm->req, size, &slice) != 0) {
+        if (!shm_alive(atomic_load(&shm->server_pid))) return -1;
+        if (deadline >= 0 && shm_now_ms() >= deadline) return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @ingroup msh
+ *
+ * This function executes a command line in the shell and waits for it.
+ *
+ * @param shm the channel
+ * @param cmd the command line
+ * @param output called with the output of the command, may be NULL
+ * @param arg the argument of output
+ * @param ret the return code of the command
+ * @param timeout_ms the longest time to wait for the command, -1 to wait
+ *        until it is done. The wait also ends when the shell process dies.
+ *
+ * @return 0 on OK, -1 when the command line is too long, on timeout or
+ *         when the shell is gone
+ */
+int msh_shm_exec(struct finsh_shm *shm, const char *cmd, finsh_shm_output_t output, void *arg, int *ret, int timeout_ms) {
+    struct shm_record record;
+    struct shm_ring *rsp = &shm->rsp;
+    char buf[SHM_TX_SIZE];
+    uint32_t size = strlen(cmd), id;
+    int64_t deadline = timeout_ms < 0 ? -1 : shm_now_ms() + timeout_ms;
+    int result = -1;
+
+    if (size > FINSH_SHM_RING_SIZE / 2) return -1;
+
+    shm_lock(shm);
+
+    /* drop what is left of an abandoned request, at a record boundary */
+    ring_get(rsp, NULL, ring_used(rsp));
+
+    id = atomic_fetch_add(&shm->next_id, 1) + 1;
+    record.type = SHM_REQ_LINE;
+    record.value = size;
+    record.id = id;
+    if (shm_wait_room(shm, sizeof(record) + size, deadline) != 0) goto out;
+    ring_put(&shm->req, &record, cmd, size);
+
+    for (;;) {
+        if (shm_wait_data(shm, sizeof(record), deadline) != 0) goto out;
+        ring_get(rsp, &record, sizeof(record));
+        if (record.type == SHM_RSP_RESULT) {
+            if (record.id != id) continue;
+            if (ret) *ret = record.value;
+            result = 0;
+            break;
+        }
+
+        /* the payload is published with the record */
+        if (record.value < 0 || (uint32_t)record.value > ring_used(rsp) || record.value > (int32_t)sizeof(buf)) {
+            ring_get(rsp, NULL, ring_used(rsp));
+            continue;
+        }
+        ring_get(rsp, buf, record.value);
+        if (output && record.id == id) output(buf, record.value, arg);
+    }
+
+out:
+    shm_unlock(shm);
+
+    return result;
+}
+
+#endif /* defined(FINSH_USING_SHM) && defined(__linux__) */
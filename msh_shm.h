@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of shared memory channel
+ */
+
+#ifndef __MSH_SHM_H__
+#define __MSH_SHM_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(FINSH_USING_SHM) && defined(__linux__)
+
+#ifndef FINSH_SHM_RING_SIZE
+#define FINSH_SHM_RING_SIZE 4096 /* must be a power of two */
+#endif
+
+#ifndef FINSH_SHM_TIMEOUT_MS
+#define FINSH_SHM_TIMEOUT_MS 1000
+#endif
+
+/*
+ * A command channel for processes on the same host. The segment holds two
+ * single producer, single consumer rings: requests carry command lines to
+ * the shell, responses carry the captured output and the return code back.
+ * Sleepers are woken with futexes on the ring indexes, a futex lock lets
+ * several clients share the channel one command at a time.
+ *
+ * A record is written whole or not at all and the shell keeps room for the
+ * result, so a client which stops reading loses output but never the
+ * result. A client gives up at its timeout or when the shell dies, the
+ * next client skips what is left of the abandoned request, and takes over
+ * the lock when its owner died.
+ */
+struct finsh_shm;
+
+typedef void (*finsh_shm_output_t)(const char *buf, uint32_t size, void *arg);
+
+/* shell side, the process which embeds finsh */
+int msh_shm_init(const char *name);
+void msh_shm_deinit(void);
+int msh_shm_poll(void);
+int msh_shm_wait(int timeout_ms);
+
+/* client side */
+struct finsh_shm *msh_shm_open(const char *name);
+void msh_shm_close(struct finsh_shm *shm);
+int msh_shm_exec(struct finsh_shm *shm, const char *cmd, finsh_shm_output_t output, void *arg, int *ret, int timeout_ms);
+
+#endif /* defined(FINSH_USING_SHM) && defined(__linux__) */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
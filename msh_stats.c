@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of command statistics
+ */
+
+#include "msh_stats.h"
+#include "msh_emit.h"
+
+#ifdef FINSH_USING_STATS
+
+#define STATS_SUB (1 << FINSH_STATS_SUB_BITS)
+
+/* commands run in the shell thread only, the counters need no locking */
+static struct msh_stats stats_table[FINSH_STATS_MAX];
+static int stats_count;
+static uint32_t stats_dropped; /* calls of commands without a free slot */
+
+static int stats_bucket(uint32_t us) {
+    int msb;
+
+    if (us < STATS_SUB) return us;
+    if (us >> FINSH_STATS_RANGE_BITS) return FINSH_STATS_BUCKETS - 1;
+
+    for (msb = FINSH_STATS_SUB_BITS; us >> (msb + 1); msb++);
+
+    return STATS_SUB * (msb - FINSH_STATS_SUB_BITS + 1) + ((us >> (msb - FINSH_STATS_SUB_BITS)) & (STATS_SUB - 1));
+}
+
+/* the highest latency counted by a bucket */
+static uint32_t stats_bucket_max(int index) {
+    int shift;
+
+    if (index < STATS_SUB) return index;
+
+    shift = index / STATS_SUB - 1;
+    return ((uint32_t)(STATS_SUB + index % STATS_SUB + 1) << shift) - 1;
+}
+
+/**
+ * @ingroup msh
+ *
+ * This function records a call of a command.
+ *
+ * @param name the name of the command, the pointer is the key of its counters
+ * @param clocks the latency of the call, in finsh_get_clock() counts
+ * @param ret the return value of the command
+ */
+void msh_stats_record(const char *name, uint32_t clocks, int ret) {
+    uint32_t us = (uint32_t)((uint64_t)clocks * 1000000 / finsh_get_clock_hz());
+    struct msh_stats *stats;
+
+    for (stats = stats_table; stats < &stats_table[stats_count]; stats++) {
+        if (stats->name == name) break;
+    }
+    if (stats == &stats_table[stats_count]) {
+        if (stats_count == FINSH_STATS_MAX) {
+            stats_dropped++;
+            return;
+        }
+        stats->name = name;
+        stats_count++;
+    }
+
+    stats->calls++;
+    stats->session_calls[finsh_get_session()]++;
+    if (ret != 0) stats->errors++;
+    if (us > stats->max) stats->max = us;
+    stats->total += us;
+    stats->hist[stats_bucket(us)]++;
+}
+
+/**
+ * @ingroup msh
+ *
+ * This function copies the counters of the commands called so far.
+ *
+ * @param stats the array to fill
+ * @param max the size of the array
+ *
+ * @return the number of entries copied
+ */
+int msh_stats_snapshot(struct msh_stats *stats, int max) {
+    int count = stats_count < max ? stats_count : max;
+
+    FINSH_MEMCPY(stats, stats_table, count * sizeof(struct msh_stats));
+
+    return count;
+}
+
+/**
+ * @ingroup msh
+ *
+ * This function estimates a latency percentile from the histogram.
+ *
+ * @param stats the counters of a command
+ * @param permille the percentile in 1/1000, e.g. 990 for p99
+ *
+ * @return the latency in us, at most 2^-FINSH_STATS_SUB_BITS above the exact value
+ */
+uint32_t msh_stats_percentile(const struct msh_stats *stats, uint32_t permille) {
+    uint64_t rank, seen = 0;
+    int index;
+
+    if (stats->calls == 0) return 0;
+
+    rank = ((uint64_t)stats->calls * permille + 999) / 1000;
+    if (rank == 0) rank = 1;
+
+    for (index = 0; index < FINSH_STATS_BUCKETS; index++) {
+        seen += stats->hist[index];
+        if (seen >= rank) break;
+    }
+
+    return stats_bucket_max(index) < stats->max ? stats_bucket_max(index) : stats->max;
+}
+
+void msh_stats_reset(void) {
+    FINSH_MEMSET(stats_table, 0, sizeof(stats_table));
+    stats_count = 0;
+    stats_dropped = 0;
+}
+
+static int msh_stats(int argc, char **argv) {
+    struct msh_stats *stats;
+
+    if (argc == 2 && FINSH_STRNCMP(argv[1], "reset", 6) == 0) {
+        msh_stats_reset();
+        return 0;
+    }
+    if (argc != 1) {
+        FINSH_PUTS("Usage: stats [reset]\r\n");
+        return -1;
+    }
+
+#ifdef FINSH_USING_EMIT
+    finsh_emit_text("command             calls   errors     mean      p50      p99      max (us)  console      rpc      shm\r\n");
+    for (stats = stats_table; stats < &stats_table[stats_count]; stats++) {
+        finsh_emit_begin();
+        finsh_emit_str("name", stats->name, "%-16s");
+        finsh_emit_uint("calls", stats->calls, " %8lu");
+        finsh_emit_uint("errors", stats->errors, " %8lu");
+        finsh_emit_uint("mean_us", stats->total / stats->calls, " %8lu");
+        finsh_emit_uint("p50_us", msh_stats_percentile(stats, 500), " %8lu");
+        finsh_emit_uint("p99_us", msh_stats_percentile(stats, 990), " %8lu");
+        finsh_emit_uint("max_us", stats->max, " %8lu");
+        finsh_emit_uint("console", stats->session_calls[FINSH_SESSION_CONSOLE], "      %8lu");
+        finsh_emit_uint("rpc", stats->session_calls[FINSH_SESSION_RPC], " %8lu");
+        finsh_emit_uint("shm", stats->session_calls[FINSH_SESSION_SHM], " %8lu");
+        finsh_emit_end("\r\n");
+    }
+#else
+    FINSH_PUTS("command             calls   errors     mean      p50      p99      max (us)  console      rpc      shm\r\n");
+    for (stats = stats_table; stats < &stats_table[stats_count]; stats++) {
+        FINSH_PRINTF("%-16s %8lu %8lu %8lu %8lu %8lu %8lu      %8lu %8lu %8lu\r\n", stats->name, (unsigned long)stats->calls,
+                     (unsigned long)stats->errors, (unsigned long)(stats->total / stats->calls),
+                     (unsigned long)msh_stats_percentile(stats, 500), (unsigned long)msh_stats_percentile(stats, 990),
+                     (unsigned long)stats->max, (unsigned long)stats->session_calls[FINSH_SESSION_CONSOLE],
+                     (unsigned long)stats->session_calls[FINSH_SESSION_RPC],
+                     (unsigned long)stats->session_calls[FINSH_SESSION_SHM]);
+    }
+#endif
+    if (stats_dropped) FINSH_PRINTF("%lu calls not counted, raise FINSH_STATS_MAX\r\n", (unsigned long)stats_dropped);
+
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(msh_stats, stats, Show the call counters and latencies of commands.);
+
+#endif /* FINSH_USING_STATS */
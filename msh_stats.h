@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of command statistics
+ */
+
+#ifndef __MSH_STATS_H__
+#define __MSH_STATS_H__
+
+#include "shell.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef FINSH_USING_STATS
+
+#ifndef FINSH_STATS_MAX
+#define FINSH_STATS_MAX 16 /* commands with counters */
+#endif
+#ifndef FINSH_STATS_SUB_BITS
+#define FINSH_STATS_SUB_BITS 2 /* 2^n buckets per power of two */
+#endif
+#ifndef FINSH_STATS_RANGE_BITS
+#define FINSH_STATS_RANGE_BITS 20 /* latencies from 2^n us, about 1 s, go to the last bucket */
+#endif
+
+#define FINSH_STATS_BUCKETS ((1 << FINSH_STATS_SUB_BITS) * (FINSH_STATS_RANGE_BITS - FINSH_STATS_SUB_BITS + 1))
+
+/*
+ * The latencies are measured with finsh_get_clock() and kept in us. The
+ * latency histogram is log-linear like HDR histograms: below
+ * 2^FINSH_STATS_SUB_BITS us each value has a bucket, above it each power
+ * of two is split in 2^FINSH_STATS_SUB_BITS buckets, so the error of a
+ * percentile is bounded by 2^-FINSH_STATS_SUB_BITS.
+ *
+ * The calls are also counted per session, see finsh_set_session(). All
+ * sessions run their commands in the shell thread, so they share one
+ * histogram and no counter needs a lock.
+ */
+struct msh_stats {
+    const char *name;
+    uint32_t calls;
+    uint32_t errors; /* calls returning non-zero */
+    uint32_t max;    /* us */
+    uint64_t total;  /* us */
+    uint32_t session_calls[FINSH_SESSION_MAX];
+    uint32_t hist[FINSH_STATS_BUCKETS];
+};
+
+void msh_stats_record(const char *name, uint32_t clocks, int ret);
+int msh_stats_snapshot(struct msh_stats *stats, int max);
+uint32_t msh_stats_percentile(const struct msh_stats *stats, uint32_t permille);
+void msh_stats_reset(void);
+
+#endif /* FINSH_USING_STATS */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
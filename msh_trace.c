@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the trace ring
+ */
+
+#include "msh_trace.h"
+
+#ifdef FINSH_USING_TRACE
+
+#if (FINSH_TRACE_SIZE & (FINSH_TRACE_SIZE - 1)) != 0
+#error "FINSH_TRACE_SIZE must be a power of two"
+#endif
+
+/*
+ * The shell thread is the only writer, an event is filled before the head
+ * moves past it and the oldest events are overwritten, so recording takes
+ * no lock and never blocks.
+ */
+static struct finsh_trace_event trace_ring[FINSH_TRACE_SIZE];
+static volatile uint32_t trace_head;
+static uint8_t trace_enabled = 1;
+
+/**
+ * @ingroup finsh
+ *
+ * This function records the begin or the end of a span.
+ *
+ * @param name the name of the span, the pointer is stored
+ * @param phase 'B', 'E' or 'C' to continue the span when it just ended
+ */
+void finsh_trace(const char *name, uint8_t phase) {
+    struct finsh_trace_event *event;
+    uint32_t head = trace_head;
+
+    if (!trace_enabled) return;
+
+    if (phase == 'C') {
+        /* back to back writes are one span, its end is taken back */
+        event = &trace_ring[(head - 1) & (FINSH_TRACE_SIZE - 1)];
+        if (head > 0 && event->phase == 'E' && event->name == name && event->session == finsh_get_session()) {
+            trace_head = head - 1;
+            return;
+        }
+        phase = 'B';
+    }
+
+    event = &trace_ring[head & (FINSH_TRACE_SIZE - 1)];
+    event->clock = finsh_get_clock();
+    event->name = name;
+    event->phase = phase;
+    event->session = finsh_get_session();
+    trace_head = head + 1;
+}
+
+void finsh_trace_enable(int enable) { trace_enabled = enable ? 1 : 0; }
+
+void finsh_trace_clear(void) { trace_head = 0; }
+
+/**
+ * @ingroup finsh
+ *
+ * This function writes the recorded events as Chrome trace-event JSON, which
+ * chrome://tracing and Perfetto open. Recording is paused meanwhile.
+ */
+void finsh_trace_dump(void) {
+    static const char *const sessions[] = {"console", "rpc", "shm"};
+    uint32_t head = trace_head, index, last;
+    uint64_t clocks = 0; /* since the first event, the 32 bit clock may wrap in between */
+    uint32_t hz = finsh_get_clock_hz();
+    uint8_t enabled = trace_enabled;
+    int i;
+
+    trace_enabled = 0;
+
+    FINSH_PUTS("{\"traceEvents\":[");
+    for (i = 0; i < FINSH_SESSION_MAX; i++) {
+        FINSH_PRINTF("%s\r\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                     i ? "," : "", i, sessions[i]);
+    }
+
+    index = head > FINSH_TRACE_SIZE ? head - FINSH_TRACE_SIZE : 0;
+    last = trace_ring[index & (FINSH_TRACE_SIZE - 1)].clock;
+    for (; index != head; index++) {
+        struct finsh_trace_event *event = &trace_ring[index & (FINSH_TRACE_SIZE - 1)];
+        unsigned long long ns;
+
+        clocks += event->clock - last;
+        last = event->clock;
+        /* whole seconds first, clocks * 10^9 overflows after 18 s of a 1 GHz clock */
+        ns = clocks / hz * 1000000000ULL + clocks % hz * 1000000000ULL / hz;
+
+        /* ts is in us, the fraction keeps the resolution of the clock */
+        FINSH_PRINTF(",\r\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":1,\"tid\":%u}", event->name,
+                     event->phase, ns / 1000, (unsigned int)(ns % 1000), event->session);
+    }
+    FINSH_PUTS("\r\n]}\r\n");
+
+    trace_enabled = enabled;
+}
+
+static int msh_trace(int argc, char **argv) {
+    if (argc == 1) {
+        finsh_trace_dump();
+        return 0;
+    }
+
+    if (argc == 2 && FINSH_STRNCMP(argv[1], "clear", 6) == 0) {
+        finsh_trace_clear();
+    } else if (argc == 2 && FINSH_STRNCMP(argv[1], "on", 3) == 0) {
+        finsh_trace_enable(1);
+    } else if (argc == 2 && FINSH_STRNCMP(argv[1], "off", 4) == 0) {
+        finsh_trace_enable(0);
+    } else {
+        FINSH_PUTS("Usage: trace [clear|on|off]\r\n");
+        return -1;
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(msh_trace, trace, Dump the trace of shell activity as Chrome JSON.);
+
+#endif /* FINSH_USING_TRACE */
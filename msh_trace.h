@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the trace ring
+ */
+
+#ifndef __MSH_TRACE_H__
+#define __MSH_TRACE_H__
+
+#include "shell.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef FINSH_USING_TRACE
+
+#ifndef FINSH_TRACE_SIZE
+#define FINSH_TRACE_SIZE 128 /* events, a power of two */
+#endif
+
+struct finsh_trace_event {
+    uint32_t clock;   /* finsh_get_clock(), the high resolution clock when there is one */
+    const char *name; /* static, e.g. the name of a command */
+    uint8_t phase;    /* 'B' begin or 'E' end of a span */
+    uint8_t session;  /* FINSH_SESSION_xxx, a lane each in the trace viewer */
+};
+
+void finsh_trace(const char *name, uint8_t phase);
+void finsh_trace_enable(int enable);
+void finsh_trace_clear(void);
+void finsh_trace_dump(void);
+
+#define FINSH_TRACE_BEGIN(name) finsh_trace(name, 'B')
+#define FINSH_TRACE_END(name)   finsh_trace(name, 'E')
+/* begins a span, or reopens the span of the same name when it is the last event */
+#define FINSH_TRACE_CONTINUE(name) finsh_trace(name, 'C')
+#else
+#define FINSH_TRACE_BEGIN(name)
+#define FINSH_TRACE_END(name)
+#define FINSH_TRACE_CONTINUE(name)
+#endif /* FINSH_USING_TRACE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -17,19 +17,34 @@
  * 2016-11-26     armink       add password authentication
  * 2018-07-02     aozima       add custom prompt support.
  * 2024-07-12     WKJay        抽离 RT-Thread
+ * 2026-10-19     WKJay        finsh_run() returns on FINSH_GETCHAR_EOF with FINSH_USING_EOF
  */
 
 #include <string.h>
 #include <stdio.h>
+#include <stdarg.h>
 
 #include "shell.h"
 #include "msh.h"
+#include "msh_async.h"
+#include "msh_shm.h"
+#include "msh_trace.h"
+#include "msh_log.h"
+#include "msh_bulk.h"
 
 struct finsh_syscall *_syscall_table_begin = NULL;
 struct finsh_syscall *_syscall_table_end = NULL;
+uint8_t _syscall_table_sorted; /* the table is an array sorted by name */
 
-struct finsh_shell g_shell;
-struct finsh_shell *shell;
+struct finsh_shell *finsh_shell_current;
+static uint32_t finsh_arena_size; /* of the arena given to finsh_system_init() */
+
+#ifndef FINSH_USING_ARENA
+/* the arena when finsh_system_init() is not given one */
+static void *finsh_arena_default[FINSH_ARENA_BYTES(FINSH_CMD_SIZE, FINSH_HISTORY_LINES, FINSH_ARG_MAX, FINSH_EXEC_DEPTH,
+                                                   FINSH_CONSOLEBUF_SIZE + 1) /
+                                 sizeof(void *)];
+#endif
 static char *finsh_prompt_custom = NULL;
 
 #if defined(_MSC_VER) || (defined(__GNUC__) && defined(__x86_64__))
@@ -43,19 +58,475 @@ struct finsh_syscall *finsh_syscall_next(struct finsh_syscall *call) {
 
 #endif /* defined(_MSC_VER) || (defined(__GNUC__) && defined(__x86_64__)) */
 
+static void finsh_output_default(const char *buf, uint32_t size) { fwrite(buf, 1, size, stdout); }
+
+/**
+ * @ingroup finsh
+ *
+ * This function writes raw bytes to the output of finsh shell.
+ *
+ * @param buf the bytes to write
+ * @param size the number of bytes
+ */
+void finsh_write(const char *buf, uint32_t size) {
+    if (finsh_shell_current == NULL || finsh_shell_current->output == NULL) {
+        finsh_output_default(buf, size);
+        return;
+    }
+#ifdef FINSH_USING_TRACE
+    /* the echo of the line is part of the input span, the output of commands is one span per burst */
+    if (!finsh_shell_current->trace_input) {
+        FINSH_TRACE_CONTINUE("output");
+        finsh_shell_current->output(buf, size);
+        FINSH_TRACE_END("output");
+        return;
+    }
+#endif
+    finsh_shell_current->output(buf, size);
+}
+
+/**
+ * @ingroup finsh
+ *
+ * This function writes a string to the output of finsh shell.
+ */
+void finsh_puts(const char *str) { finsh_write(str, FINSH_STRLEN(str)); }
+
+/**
+ * @ingroup finsh
+ *
+ * This function writes a character to the output of finsh shell.
+ */
+void finsh_putc(char ch) { finsh_write(&ch, 1); }
+
+/* where the printf writes, NULL is the shell output */
+struct finsh_sink {
+    char *buf;
+    uint32_t size;
+    uint32_t length; /* as if buf were large enough */
+};
+
+static void finsh_sink_write(struct finsh_sink *sink, const char *buf, uint32_t size) {
+    if (sink == NULL) {
+        finsh_write(buf, size);
+        return;
+    }
+
+    if (sink->length < sink->size) {
+        uint32_t room = sink->size - sink->length;
+
+        FINSH_MEMCPY(sink->buf + sink->length, buf, size < room ? size : room);
+    }
+    sink->length += size;
+}
+
+static void finsh_pad(struct finsh_sink *sink, char ch, int count) {
+    static const char spaces[] = "                ";
+    static const char zeros[] = "0000000000000000";
+    const char *pad = (ch == '0') ? zeros : spaces;
+
+    while (count > 0) {
+        int size = count > (int)sizeof(spaces) - 1 ? (int)sizeof(spaces) - 1 : count;
+
+        finsh_sink_write(sink, pad, size);
+        count -= size;
+    }
+}
+
+#ifndef FINSH_USING_LIBC_PRINTF
+
+/*
+ * A small printf, the output is written straight to the shell output or
+ * to the buffer of sink.
+ *
+ * Supported: %d %i %u %x %X %o %p %c %s %%, the flags '-' and '0', width
+ * and precision (also '*'), the length modifiers 'l', 'll', 'h' and 'z'.
+ */
+static int finsh_vprintf(struct finsh_sink *sink, const char *fmt, va_list args) {
+    const char *run = fmt;
+    int total = 0;
+
+    for (; *fmt; fmt++) {
+        char digits[24]; /* room for the 22 octal digits of an unsigned long long */
+        const char *str = digits;
+        int left = 0, pad = ' ', width = 0, precision = -1, longs = 0;
+        int size, length, zeros = 0, negative = 0, prefix_size = 0;
+        const char *prefix = "";
+        unsigned long long value;
+        unsigned int base = 10;
+        const char *hex = "0123456789abcdef";
+
+        if (*fmt != '%') continue;
+
+        /* write the literal text before the conversion */
+        if (fmt > run) {
+            finsh_sink_write(sink, run, fmt - run);
+            total += fmt - run;
+        }
+        fmt++;
+
+        for (;; fmt++) {
+            if (*fmt == '-')
+                left = 1;
+            else if (*fmt == '0')
+                pad = '0';
+            else
+                break;
+        }
+        if (left) pad = ' ';
+
+        if (*fmt == '*') {
+            width = va_arg(args, int);
+            if (width < 0) {
+                left = 1;
+                width = -width;
+            }
+            fmt++;
+        } else {
+            while (*fmt >= '0' && *fmt <= '9') width = width * 10 + (*fmt++ - '0');
+        }
+
+        if (*fmt == '.') {
+            fmt++;
+            precision = 0;
+            if (*fmt == '*') {
+                precision = va_arg(args, int);
+                fmt++;
+            } else {
+                while (*fmt >= '0' && *fmt <= '9') precision = precision * 10 + (*fmt++ - '0');
+            }
+        }
+
+        for (;; fmt++) {
+            if (*fmt == 'l')
+                longs++;
+            else if (*fmt == 'z')
+                longs = sizeof(size_t) > sizeof(int) ? 1 : 0;
+            else if (*fmt != 'h')
+                break;
+        }
+
+        switch (*fmt) {
+            case 'c':
+                digits[0] = (char)va_arg(args, int);
+                size = 1;
+                break;
+
+            case 's':
+                str = va_arg(args, const char *);
+                if (str == NULL) str = "(null)";
+                for (size = 0; str[size] && (precision < 0 || size < precision); size++);
+                break;
+
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+            case 'p':
+                if (*fmt == 'p') {
+                    value = (uintptr_t)va_arg(args, void *);
+                    longs = 0;
+                } else if (*fmt == 'd' || *fmt == 'i') {
+                    long long svalue = longs > 1 ? va_arg(args, long long) : longs ? va_arg(args, long) : va_arg(args, int);
+
+                    negative = svalue < 0;
+                    value = negative ? 0ULL - (unsigned long long)svalue : (unsigned long long)svalue;
+                } else {
+                    value = longs > 1 ? va_arg(args, unsigned long long) : longs ? va_arg(args, unsigned long) : va_arg(args, unsigned int);
+                }
+
+                if (*fmt == 'x' || *fmt == 'p') base = 16;
+                if (*fmt == 'X') {
+                    base = 16;
+                    hex = "0123456789ABCDEF";
+                }
+                if (*fmt == 'o') base = 8;
+
+                /* convert from the end of digits, "%.0d" of 0 has no digit */
+                str = &digits[sizeof(digits)];
+                while (value || (str == &digits[sizeof(digits)] && precision != 0)) {
+                    *(char *)--str = hex[value % base];
+                    value /= base;
+                }
+                size = &digits[sizeof(digits)] - str;
+
+                /* the precision is the minimum number of digits, the '0' flag is ignored then */
+                if (precision >= 0) {
+                    pad = ' ';
+                    if (precision > size) zeros = precision - size;
+                }
+                if (negative || *fmt == 'p') {
+                    prefix = negative ? "-" : "0x";
+                    prefix_size = negative ? 1 : 2;
+                }
+                break;
+
+            case '\0':
+                fmt--;
+                /* fall through */
+            default:
+                /* "%%" writes '%', an unknown conversion writes its character */
+                str = fmt;
+                size = 1;
+                pad = ' ';
+                width = 0;
+                break;
+        }
+
+        /* the sign or "0x" goes before zero padding, after space padding */
+        length = prefix_size + zeros + size;
+        if (pad == '0' && width > length) {
+            zeros += width - length;
+            length = width;
+        }
+
+        if (!left) finsh_pad(sink, ' ', width - length);
+        if (prefix_size) finsh_sink_write(sink, prefix, prefix_size);
+        finsh_pad(sink, '0', zeros);
+        finsh_sink_write(sink, str, size);
+        if (left) finsh_pad(sink, ' ', width - length);
+        total += (width > length) ? width : length;
+
+        run = fmt + 1;
+    }
+
+    if (fmt > run) {
+        finsh_sink_write(sink, run, fmt - run);
+        total += fmt - run;
+    }
+
+    return total;
+}
+#else
+/*
+ * The output of libc printf which does not fit in buf is formatted one
+ * conversion at a time and padded here, a string is written straight from
+ * the argument. Only a single number longer than buf, e.g. "%f" of 1e300,
+ * is cut.
+ */
+static int finsh_vprintf_stream(char *buf, int size, const char *fmt, va_list args) {
+    int total = 0;
+
+    while (*fmt) {
+        const char *end, *str = buf;
+        char spec[32], *to = spec, pad = ' ';
+        int left = 0, width = 0, precision = -1, longs = 0, length, prefix = 0;
+
+        if (*fmt != '%') {
+            for (end = fmt; *end && *end != '%'; end++);
+            finsh_write(fmt, end - fmt);
+            total += end - fmt;
+            fmt = end;
+            continue;
+        }
+
+        /* copy the conversion without the width and the flags of the padding */
+        *to++ = '%';
+        for (end = fmt + 1; *end && strchr("-+ #0", *end); end++) {
+            if (*end == '-')
+                left = 1;
+            else if (*end == '0')
+                pad = '0';
+            else if (to < &spec[8])
+                *to++ = *end;
+        }
+        if (*end == '*') {
+            width = va_arg(args, int);
+            end++;
+        } else {
+            while (*end >= '0' && *end <= '9') width = width * 10 + (*end++ - '0');
+        }
+        if (width < 0) {
+            left = 1;
+            width = -width;
+        }
+        if (*end == '.') {
+            precision = 0;
+            if (*++end == '*') {
+                precision = va_arg(args, int);
+                end++;
+            } else {
+                while (*end >= '0' && *end <= '9') precision = precision * 10 + (*end++ - '0');
+            }
+            if (precision >= 0) to += sprintf(to, ".%d", precision);
+        }
+        for (; *end && strchr("hlLjzt", *end) && to < &spec[sizeof(spec) - 2]; end++) {
+            longs += (*end != 'h');
+            *to++ = *end;
+        }
+        if (*end == '\0' || strchr("hlLjzt", *end)) {
+            finsh_write(fmt, FINSH_STRLEN(fmt));
+            return total + (int)FINSH_STRLEN(fmt);
+        }
+        *to++ = *end;
+        *to = '\0';
+        if (left) pad = ' ';
+
+        switch (*end) {
+            case 'd':
+            case 'i':
+                if (precision >= 0) pad = ' ';
+                length = longs > 1 ? snprintf(buf, size, spec, va_arg(args, long long))
+                         : longs   ? snprintf(buf, size, spec, va_arg(args, long))
+                                   : snprintf(buf, size, spec, va_arg(args, int));
+                break;
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                if (precision >= 0) pad = ' ';
+                length = longs > 1 ? snprintf(buf, size, spec, va_arg(args, unsigned long long))
+                         : longs   ? snprintf(buf, size, spec, va_arg(args, unsigned long))
+                                   : snprintf(buf, size, spec, va_arg(args, unsigned int));
+                break;
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                length = end[-1] == 'L' ? snprintf(buf, size, spec, va_arg(args, long double))
+                                        : snprintf(buf, size, spec, va_arg(args, double));
+                break;
+            case 'c':
+                pad = ' ';
+                length = snprintf(buf, size, spec, va_arg(args, int));
+                break;
+            case 'p':
+                pad = ' ';
+                length = snprintf(buf, size, spec, va_arg(args, void *));
+                break;
+            case 's':
+                pad = ' ';
+                str = va_arg(args, const char *);
+                if (str == NULL) str = "(null)";
+                for (length = 0; str[length] && (precision < 0 || length < precision); length++);
+                break;
+            default:
+                /* "%%", "%n" is not supported */
+                if (*end == 'n') (void)va_arg(args, int *);
+                str = "%";
+                length = *end == '%' ? 1 : 0;
+                break;
+        }
+
+        if (length < 0) return length;
+        if (str == buf && length > size - 1) length = size - 1;
+
+        /* the sign and "0x" go before zero padding */
+        if (pad == '0' && width > length) {
+            if (str[0] == '-' || str[0] == '+' || str[0] == ' ') prefix = 1;
+            if (str[prefix] == '0' && (str[prefix + 1] == 'x' || str[prefix + 1] == 'X')) prefix += 2;
+            finsh_write(str, prefix);
+        }
+        if (!left) finsh_pad(NULL, pad, width - length);
+        finsh_write(str + prefix, length - prefix);
+        if (left) finsh_pad(NULL, ' ', width - length);
+        total += length > width ? length : width;
+
+        fmt = end + 1;
+    }
+
+    return total;
+}
+#endif /* FINSH_USING_LIBC_PRINTF */
+
+/**
+ * @ingroup finsh
+ *
+ * This function prints formatted text to the output of finsh shell, it is
+ * the default FINSH_PRINTF.
+ *
+ * @return the number of characters written
+ */
+int finsh_printf(const char *fmt, ...) {
+    va_list args;
+    int length;
+#ifdef FINSH_USING_LIBC_PRINTF
+    char buf[FINSH_CONSOLEBUF_SIZE];
+
+    va_start(args, fmt);
+    length = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+
+    if (length < 0) return length;
+    if (length < (int)sizeof(buf)) {
+        finsh_write(buf, length);
+    } else {
+        va_start(args, fmt);
+        length = finsh_vprintf_stream(buf, sizeof(buf), fmt, args);
+        va_end(args);
+    }
+#else
+    va_start(args, fmt);
+    length = finsh_vprintf(NULL, fmt, args);
+    va_end(args);
+#endif
+
+    return length;
+}
+
+/**
+ * @ingroup finsh
+ *
+ * This function formats into buf like vsnprintf(), with the printf of the
+ * shell, e.g. for output which is written later.
+ *
+ * @return the length of the whole output, buf holds size - 1 bytes of it
+ */
+int finsh_vsnprintf(char *buf, uint32_t size, const char *fmt, va_list args) {
+#ifdef FINSH_USING_LIBC_PRINTF
+    return vsnprintf(buf, size, fmt, args);
+#else
+    struct finsh_sink sink;
+    int length;
+
+    sink.buf = buf;
+    sink.size = size ? size - 1 : 0;
+    sink.length = 0;
+    length = finsh_vprintf(&sink, fmt, args);
+    if (size) buf[sink.length < sink.size ? sink.length : sink.size] = '\0';
+
+    return length;
+#endif
+}
+
+/**
+ * @ingroup finsh
+ *
+ * This function redirects the output of finsh shell, e.g. to capture the
+ * output of a command.
+ *
+ * @param output the new output, NULL for stdout
+ *
+ * @return the previous output
+ */
+finsh_output_t finsh_set_output(finsh_output_t output) {
+    finsh_output_t old = finsh_shell_current->output;
+
+    finsh_shell_current->output = output ? output : finsh_output_default;
+
+    return old;
+}
+
 #define _MSH_PROMPT "msh "
 
 const char *finsh_get_prompt(void) {
-    static char finsh_prompt[FINSH_CONSOLEBUF_SIZE + 1] = {0};
+    char *finsh_prompt = finsh_shell_current->prompt;
 
     /* check prompt mode */
-    if (!shell->prompt_mode) {
+    if (!finsh_shell_current->prompt_mode) {
         finsh_prompt[0] = '\0';
         return finsh_prompt;
     }
 
     if (finsh_prompt_custom) {
-        FINSH_STRNCPY(finsh_prompt, finsh_prompt_custom, sizeof(finsh_prompt) - 1);
+        FINSH_STRNCPY(finsh_prompt, finsh_prompt_custom, finsh_shell_current->prompt_size - 1);
+        finsh_prompt[finsh_shell_current->prompt_size - 1] = '\0';
         return finsh_prompt;
     }
     FINSH_STRCPY(finsh_prompt, _MSH_PROMPT);
@@ -65,6 +536,48 @@ const char *finsh_get_prompt(void) {
     return finsh_prompt;
 }
 
+/* the echoed part of the line before the cursor, a paste is echoed at its end */
+static uint16_t finsh_line_echoed(void) {
+    return finsh_shell_current->paste ? finsh_shell_current->paste_from : finsh_shell_current->line_curpos;
+}
+
+/**
+ * @ingroup finsh
+ *
+ * This function clears the prompt and the half-typed line, so output which
+ * is not a reply to the line can be written in its place. Call
+ * finsh_line_show() when done. Without echo there is nothing to clear.
+ */
+void finsh_line_hide(void) {
+    uint32_t column;
+
+    if (!finsh_shell_current->echo_mode) return;
+
+    /* a line longer than the terminal wraps, go up to its first row */
+    column = FINSH_STRLEN(FINSH_PROMPT) + finsh_line_echoed();
+    if (column > FINSH_TERM_COLUMNS) FINSH_PRINTF("\x1b[%luA", (unsigned long)((column - 1) / FINSH_TERM_COLUMNS));
+    FINSH_PUTS("\r\x1b[J");
+}
+
+/**
+ * @ingroup finsh
+ *
+ * This function draws the prompt and the line again after
+ * finsh_line_hide(), the cursor goes back where it was. The bytes of a
+ * paste are left to the end of the paste.
+ */
+void finsh_line_show(void) {
+    uint16_t i;
+
+    if (!finsh_shell_current->echo_mode) return;
+
+    FINSH_PUTS(FINSH_PROMPT);
+    finsh_write(finsh_shell_current->line, finsh_line_echoed());
+    finsh_write(&finsh_shell_current->line[finsh_shell_current->line_curpos],
+                finsh_shell_current->line_position - finsh_shell_current->line_curpos);
+    for (i = finsh_shell_current->line_curpos; i < finsh_shell_current->line_position; i++) FINSH_PUTC('\b');
+}
+
 /**
  * @ingroup finsh
  *
@@ -73,11 +586,11 @@ const char *finsh_get_prompt(void) {
  * @return prompt the prompt mode, 0 disable prompt mode, other values enable prompt mode.
  */
 uint32_t finsh_get_prompt_mode(void) {
-    if (shell == NULL) {
-        FINSH_PRINTF("shell is NULL\r\n");
+    if (finsh_shell_current == NULL) {
+        FINSH_PUTS("shell is NULL\r\n");
         return 0;
     }
-    return shell->prompt_mode;
+    return finsh_shell_current->prompt_mode;
 }
 
 /**
@@ -90,11 +603,11 @@ uint32_t finsh_get_prompt_mode(void) {
  * @param prompt the prompt mode
  */
 void finsh_set_prompt_mode(uint32_t prompt_mode) {
-    if (shell == NULL) {
-        FINSH_PRINTF("shell is NULL\r\n");
+    if (finsh_shell_current == NULL) {
+        FINSH_PUTS("shell is NULL\r\n");
         return;
     }
-    shell->prompt_mode = prompt_mode;
+    finsh_shell_current->prompt_mode = prompt_mode;
 }
 
 /**
@@ -107,13 +620,32 @@ void finsh_set_prompt_mode(uint32_t prompt_mode) {
  * @param echo the echo mode
  */
 void finsh_set_echo(uint32_t echo) {
-    if (shell == NULL) {
-        FINSH_PRINTF("shell is NULL\r\n");
+    if (finsh_shell_current == NULL) {
+        FINSH_PUTS("shell is NULL\r\n");
         return;
     }
-    shell->echo_mode = (uint8_t)echo;
+    finsh_shell_current->echo_mode = (uint8_t)echo;
 }
 
+/**
+ * @ingroup finsh
+ *
+ * This function sets the session of the commands run from now on, the
+ * channels other than the console set it around each command they run.
+ *
+ * @param session FINSH_SESSION_xxx
+ *
+ * @return the previous session
+ */
+uint8_t finsh_set_session(uint8_t session) {
+    uint8_t old = finsh_shell_current->session;
+
+    finsh_shell_current->session = session < FINSH_SESSION_MAX ? session : FINSH_SESSION_CONSOLE;
+    return old;
+}
+
+uint8_t finsh_get_session(void) { return finsh_shell_current ? finsh_shell_current->session : FINSH_SESSION_CONSOLE; }
+
 /**
  * @ingroup finsh
  *
@@ -122,14 +654,161 @@ void finsh_set_echo(uint32_t echo) {
  * @return the echo mode
  */
 uint32_t finsh_get_echo() {
-    if (shell == NULL) {
-        FINSH_PRINTF("shell is NULL\r\n");
+    if (finsh_shell_current == NULL) {
+        FINSH_PUTS("shell is NULL\r\n");
         return 0;
     }
 
-    return shell->echo_mode;
+    return finsh_shell_current->echo_mode;
+}
+
+/**
+ * @ingroup finsh
+ *
+ * This function gets the current tick of finsh shell.
+ *
+ * @return the tick count, 0 when no tick source was configured
+ */
+uint32_t finsh_get_tick(void) {
+    if (finsh_shell_current == NULL || finsh_shell_current->get_tick == NULL) return 0;
+
+    return finsh_shell_current->get_tick();
+}
+
+/**
+ * @ingroup finsh
+ *
+ * This function gets the clock used for timings, the high resolution clock
+ * of the configuration or the tick when there is none.
+ *
+ * @return the clock count, at finsh_get_clock_hz()
+ */
+uint32_t finsh_get_clock(void) {
+    if (finsh_shell_current && finsh_shell_current->get_clock) return finsh_shell_current->get_clock();
+
+    return finsh_get_tick();
+}
+
+uint32_t finsh_get_clock_hz(void) {
+    if (finsh_shell_current && finsh_shell_current->get_clock) return finsh_shell_current->clock_hz;
+
+    return FINSH_TICK_PER_SECOND;
 }
 
+/**
+ * @ingroup finsh
+ *
+ * This function hands all input to a hook instead of the line editor, for
+ * binary protocols running over the console. There is no echo and no
+ * prompt while a hook is set.
+ *
+ * @param hook the input hook, NULL to return to the line editor
+ */
+void finsh_set_input_hook(finsh_input_hook_t hook) { finsh_shell_current->input_hook = hook; }
+
+#ifdef FINSH_USING_CANCEL
+/**
+ * @ingroup finsh
+ *
+ * This function checks whether the running command should stop. Long running
+ * commands poll it in their loops and return as soon as it is non-zero.
+ *
+ * When FINSH_CANCEL_NO_POLL is not defined, pending input is read from
+ * get_char (which must not block) to look for ctrl-c, other characters are
+ * kept and handed to the line editor once the command returns.
+ *
+ * @return FINSH_CANCEL_NONE to keep going, otherwise the cancel reason
+ */
+int finsh_cancelled(void) {
+    if (finsh_shell_current->cancel) return finsh_shell_current->cancel;
+
+    if (finsh_shell_current->deadline_armed && (int32_t)(finsh_get_tick() - finsh_shell_current->deadline) >= 0) {
+        finsh_shell_current->cancel = FINSH_CANCEL_TIMEOUT;
+        return finsh_shell_current->cancel;
+    }
+
+#ifndef FINSH_CANCEL_NO_POLL
+    /* binary input is never ctrl-c */
+    while (finsh_shell_current->input_hook == NULL && finsh_shell_current->typeahead_count < FINSH_TYPEAHEAD_SIZE) {
+        int ch = finsh_shell_current->get_char();
+        if (ch < 0) break;
+
+        if (ch == FINSH_KEY_CTRL_C) {
+            finsh_shell_current->cancel = FINSH_CANCEL_INTR;
+            break;
+        }
+        finsh_shell_current->typeahead[(finsh_shell_current->typeahead_head + finsh_shell_current->typeahead_count) %
+                                       FINSH_TYPEAHEAD_SIZE] = (uint8_t)ch;
+        finsh_shell_current->typeahead_count++;
+    }
+#endif
+
+    return finsh_shell_current->cancel;
+}
+
+/**
+ * @ingroup finsh
+ *
+ * This function requests the running command to stop, as if ctrl-c was
+ * typed. It only sets a flag, so it can be called from an interrupt or
+ * another thread, e.g. a uart receive handler when get_char blocks.
+ */
+void finsh_cancel(void) { finsh_shell_current->cancel = FINSH_CANCEL_INTR; }
+
+/**
+ * @ingroup finsh
+ *
+ * This function clears the cancel state and the deadline around a command.
+ *
+ * @return the cancel reason which was pending, without polling the input
+ */
+int finsh_cancel_reset(void) {
+    int reason = finsh_shell_current->cancel;
+
+    finsh_shell_current->cancel = FINSH_CANCEL_NONE;
+    finsh_shell_current->deadline_armed = 0;
+
+    return reason;
+}
+
+/**
+ * @ingroup finsh
+ *
+ * This function arms a deadline for the running command. An earlier
+ * deadline which is already armed is kept.
+ *
+ * @param ticks the time limit from now, in ticks
+ *
+ * @return 0 on OK, -1 when there is no tick source
+ */
+int finsh_set_deadline(uint32_t ticks) {
+    uint32_t deadline;
+
+    if (finsh_shell_current->get_tick == NULL) return -1;
+
+    deadline = finsh_shell_current->get_tick() + ticks;
+    if (!finsh_shell_current->deadline_armed || (int32_t)(deadline - finsh_shell_current->deadline) < 0) {
+        finsh_shell_current->deadline = deadline;
+        finsh_shell_current->deadline_armed = 1;
+    }
+
+    return 0;
+}
+
+static int finsh_getchar(void) {
+    if (finsh_shell_current->typeahead_count) {
+        int ch = finsh_shell_current->typeahead[finsh_shell_current->typeahead_head];
+        finsh_shell_current->typeahead_head = (finsh_shell_current->typeahead_head + 1) % FINSH_TYPEAHEAD_SIZE;
+        finsh_shell_current->typeahead_count--;
+        return ch;
+    }
+
+    return finsh_shell_current->get_char();
+}
+#else
+#define finsh_getchar() finsh_shell_current->get_char()
+#endif /* FINSH_USING_CANCEL */
+
 #ifdef FINSH_USING_AUTH
 /**
  * set a new password for finsh
@@ -146,7 +825,7 @@ int finsh_set_password(const char *password) {
     if (pw_len < FINSH_PASSWORD_MIN || pw_len > FINSH_PASSWORD_MAX) return -1;
 
     // level = rt_hw_interrupt_disable();
-    FINSH_STRNCPY(shell->password, password, FINSH_PASSWORD_MAX);
+    FINSH_STRNCPY(finsh_shell_current->password, password, FINSH_PASSWORD_MAX);
     // rt_hw_interrupt_enable(level);
 
     return 0;
@@ -157,7 +836,7 @@ int finsh_set_password(const char *password) {
  *
  * @return password
  */
-const char *finsh_get_password(void) { return shell->password; }
+const char *finsh_get_password(void) { return finsh_shell_current->password; }
 
 static void finsh_wait_auth(void) {
     int ch;
@@ -168,35 +847,35 @@ static void finsh_wait_auth(void) {
     if (FINSH_STRLEN(finsh_get_password()) == 0) return;
 
     while (1) {
-        FINSH_PRINTF("Password for login: ");
+        FINSH_PUTS("Password for login: ");
         while (!input_finish) {
             while (1) {
                 /* read one character from device */
-                ch = (int)shell->get_char();
+                ch = (int)finsh_shell_current->get_char();
                 if (ch < 0) {
                     continue;
                 }
 
                 if (ch >= ' ' && ch <= '~' && cur_pos < FINSH_PASSWORD_MAX) {
                     /* change the printable characters to '*' */
-                    FINSH_PRINTF("*");
+                    FINSH_PUTC('*');
                     password[cur_pos++] = ch;
                 } else if (ch == '\b' && cur_pos > 0) {
                     /* backspace */
                     cur_pos--;
                     password[cur_pos] = '\0';
-                    FINSH_PRINTF("\b \b");
+                    FINSH_PUTS("\b \b");
                 } else if (ch == '\r' || ch == '\n') {
-                    FINSH_PRINTF("\r\n");
+                    FINSH_PUTS("\r\n");
                     input_finish = 1;
                     break;
                 }
             }
         }
-        if (!FINSH_STRNCMP(shell->password, password, FINSH_PASSWORD_MAX))
+        if (!FINSH_STRNCMP(finsh_shell_current->password, password, FINSH_PASSWORD_MAX))
             return;
         else {
-            FINSH_PRINTF("Sorry, try again.\r\n");
+            FINSH_PUTS("Sorry, try again.\r\n");
             cur_pos = 0;
             input_finish = 0;
             FINSH_MEMSET(password, '\0', FINSH_PASSWORD_MAX);
@@ -206,252 +885,595 @@ static void finsh_wait_auth(void) {
 #endif /* FINSH_USING_AUTH */
 
 static void shell_auto_complete(char *prefix) {
-    FINSH_PRINTF("\r\n");
+    FINSH_PUTS("\r\n");
     msh_auto_complete(prefix);
 
     FINSH_PRINTF("%s%s", FINSH_PROMPT, prefix);
 }
 
 #ifdef FINSH_USING_HISTORY
-static uint8_t shell_handle_history(struct finsh_shell *shell) {
+/* the history entry at index */
+#define SHELL_HISTORY(index) (&finsh_shell_current->cmd_history[(index) * finsh_shell_current->line_size])
+
+static uint8_t shell_handle_history(void) {
 #if defined(_WIN32)
     int i;
-    FINSH_PRINTF("\r");
+    FINSH_PUTS("\r");
 
-    for (i = 0; i <= 60; i++) putchar(' ');
-    FINSH_PRINTF("\r");
+    for (i = 0; i <= 60; i++) FINSH_PUTC(' ');
+    FINSH_PUTS("\r");
 
 #else
-    FINSH_PRINTF("\033[2K\r");
+    FINSH_PUTS("\033[2K\r");
 #endif
-    FINSH_PRINTF("%s%s", FINSH_PROMPT, shell->line);
+    FINSH_PRINTF("%s%s", FINSH_PROMPT, finsh_shell_current->line);
     return 0;
 }
 
-static void shell_push_history(struct finsh_shell *shell) {
-    if (shell->line_position != 0) {
+static void shell_push_history(void) {
+    if (finsh_shell_current->line_position != 0) {
         /* push history */
-        if (shell->history_count >= FINSH_HISTORY_LINES) {
+        if (finsh_shell_current->history_count >= finsh_shell_current->history_lines) {
             /* if current cmd is same as last cmd, don't push */
-            if (FINSH_MEMCMP(&shell->cmd_history[FINSH_HISTORY_LINES - 1], shell->line, FINSH_CMD_SIZE)) {
+            if (FINSH_MEMCMP(SHELL_HISTORY(finsh_shell_current->history_lines - 1), finsh_shell_current->line,
+                             finsh_shell_current->line_size)) {
                 /* move history */
                 int index;
-                for (index = 0; index < FINSH_HISTORY_LINES - 1; index++) {
-                    FINSH_MEMCPY(&shell->cmd_history[index][0], &shell->cmd_history[index + 1][0], FINSH_CMD_SIZE);
+                for (index = 0; index < finsh_shell_current->history_lines - 1; index++) {
+                    FINSH_MEMCPY(SHELL_HISTORY(index), SHELL_HISTORY(index + 1), finsh_shell_current->line_size);
                 }
-                FINSH_MEMSET(&shell->cmd_history[index][0], 0, FINSH_CMD_SIZE);
-                FINSH_MEMCPY(&shell->cmd_history[index][0], shell->line, shell->line_position);
+                FINSH_MEMSET(SHELL_HISTORY(index), 0, finsh_shell_current->line_size);
+                FINSH_MEMCPY(SHELL_HISTORY(index), finsh_shell_current->line, finsh_shell_current->line_position);
 
                 /* it's the maximum history */
-                shell->history_count = FINSH_HISTORY_LINES;
+                finsh_shell_current->history_count = finsh_shell_current->history_lines;
             }
         } else {
             /* if current cmd is same as last cmd, don't push */
-            if (shell->history_count == 0 || FINSH_MEMCMP(&shell->cmd_history[shell->history_count - 1], shell->line, FINSH_CMD_SIZE)) {
-                shell->current_history = shell->history_count;
-                FINSH_MEMSET(&shell->cmd_history[shell->history_count][0], 0, FINSH_CMD_SIZE);
-                FINSH_MEMCPY(&shell->cmd_history[shell->history_count][0], shell->line, shell->line_position);
+            if (finsh_shell_current->history_count == 0 ||
+                FINSH_MEMCMP(SHELL_HISTORY(finsh_shell_current->history_count - 1), finsh_shell_current->line,
+                             finsh_shell_current->line_size)) {
+                finsh_shell_current->current_history = finsh_shell_current->history_count;
+                FINSH_MEMSET(SHELL_HISTORY(finsh_shell_current->history_count), 0, finsh_shell_current->line_size);
+                FINSH_MEMCPY(SHELL_HISTORY(finsh_shell_current->history_count), finsh_shell_current->line,
+                             finsh_shell_current->line_position);
 
                 /* increase count and set current history position */
-                shell->history_count++;
+                finsh_shell_current->history_count++;
             }
         }
     }
-    shell->current_history = shell->history_count;
+    finsh_shell_current->current_history = finsh_shell_current->history_count;
 }
 #endif
 
-void finsh_run(void) {
-    int ch;
+/*
+ * The input decoder: each byte has a class, the state and the class give
+ * the action and the next state. Unknown control sequences are dropped
+ * whole, so they never leak into the line.
+ */
+enum key_class {
+    KEY_CLASS_PRINT,   /* printable, and 0x80 to 0xFF */
+    KEY_CLASS_CTRL,    /* 0x00 to 0x1F but ESC, and DEL */
+    KEY_CLASS_ESC,     /* 0x1B */
+    KEY_CLASS_CSI,     /* '[' */
+    KEY_CLASS_SS3,     /* 'O' */
+    KEY_CLASS_DIGIT,   /* '0' to '9' */
+    KEY_CLASS_PARAM,   /* ':' to '?', e.g. ';' between numbers */
+    KEY_CLASS_INTER,   /* ' ' to '/' */
+    KEY_CLASS_FINAL,   /* '@' to '~' but '[' and 'O' */
+    KEY_CLASS_NUMBER,
+};
+
+enum key_action {
+    KEY_INSERT,   /* a character of the line */
+    KEY_CONTROL,  /* enter, backspace, tab, ctrl-c */
+    KEY_START,    /* the start of a sequence */
+    KEY_NEXT,     /* go to the next state */
+    KEY_DIGIT,    /* a digit of the first number */
+    KEY_SKIP,     /* a byte of the sequence which is not used */
+    KEY_DISPATCH, /* the last byte of the sequence */
+    KEY_AGAIN,    /* not a sequence, handle the byte as normal input */
+};
+
+#define KEY(action, stat) (((action) << 4) | (stat))
+
+static const uint8_t key_table[][KEY_CLASS_NUMBER] = {
+    [WAIT_NORMAL] =
+        {
+            [KEY_CLASS_PRINT] = KEY(KEY_INSERT, WAIT_NORMAL),
+            [KEY_CLASS_CTRL] = KEY(KEY_CONTROL, WAIT_NORMAL),
+            [KEY_CLASS_ESC] = KEY(KEY_START, WAIT_SPEC_KEY),
+            [KEY_CLASS_CSI] = KEY(KEY_INSERT, WAIT_NORMAL),
+            [KEY_CLASS_SS3] = KEY(KEY_INSERT, WAIT_NORMAL),
+            [KEY_CLASS_DIGIT] = KEY(KEY_INSERT, WAIT_NORMAL),
+            [KEY_CLASS_PARAM] = KEY(KEY_INSERT, WAIT_NORMAL),
+            [KEY_CLASS_INTER] = KEY(KEY_INSERT, WAIT_NORMAL),
+            [KEY_CLASS_FINAL] = KEY(KEY_INSERT, WAIT_NORMAL),
+        },
+    [WAIT_SPEC_KEY] =
+        {
+            [KEY_CLASS_PRINT] = KEY(KEY_AGAIN, WAIT_NORMAL),
+            [KEY_CLASS_CTRL] = KEY(KEY_AGAIN, WAIT_NORMAL),
+            [KEY_CLASS_ESC] = KEY(KEY_START, WAIT_SPEC_KEY),
+            [KEY_CLASS_CSI] = KEY(KEY_NEXT, WAIT_FUNC_KEY),
+            [KEY_CLASS_SS3] = KEY(KEY_NEXT, WAIT_SS3_KEY),
+            [KEY_CLASS_DIGIT] = KEY(KEY_AGAIN, WAIT_NORMAL),
+            [KEY_CLASS_PARAM] = KEY(KEY_AGAIN, WAIT_NORMAL),
+            [KEY_CLASS_INTER] = KEY(KEY_AGAIN, WAIT_NORMAL),
+            [KEY_CLASS_FINAL] = KEY(KEY_AGAIN, WAIT_NORMAL),
+        },
+    [WAIT_FUNC_KEY] =
+        {
+            [KEY_CLASS_PRINT] = KEY(KEY_SKIP, WAIT_NORMAL),
+            [KEY_CLASS_CTRL] = KEY(KEY_AGAIN, WAIT_NORMAL),
+            [KEY_CLASS_ESC] = KEY(KEY_START, WAIT_SPEC_KEY),
+            [KEY_CLASS_CSI] = KEY(KEY_NEXT, WAIT_SKIP_KEY), /* ESC [ [ A, the function keys of the linux console */
+            [KEY_CLASS_SS3] = KEY(KEY_DISPATCH, WAIT_NORMAL),
+            [KEY_CLASS_DIGIT] = KEY(KEY_DIGIT, WAIT_FUNC_KEY),
+            [KEY_CLASS_PARAM] = KEY(KEY_SKIP, WAIT_FUNC_KEY),
+            [KEY_CLASS_INTER] = KEY(KEY_SKIP, WAIT_FUNC_KEY),
+            [KEY_CLASS_FINAL] = KEY(KEY_DISPATCH, WAIT_NORMAL),
+        },
+    [WAIT_SS3_KEY] =
+        {
+            [KEY_CLASS_PRINT] = KEY(KEY_SKIP, WAIT_NORMAL),
+            [KEY_CLASS_CTRL] = KEY(KEY_AGAIN, WAIT_NORMAL),
+            [KEY_CLASS_ESC] = KEY(KEY_START, WAIT_SPEC_KEY),
+            [KEY_CLASS_CSI] = KEY(KEY_DISPATCH, WAIT_NORMAL),
+            [KEY_CLASS_SS3] = KEY(KEY_DISPATCH, WAIT_NORMAL),
+            [KEY_CLASS_DIGIT] = KEY(KEY_SKIP, WAIT_SS3_KEY), /* the modifiers, e.g. ESC O 5 A */
+            [KEY_CLASS_PARAM] = KEY(KEY_SKIP, WAIT_SS3_KEY),
+            [KEY_CLASS_INTER] = KEY(KEY_SKIP, WAIT_SS3_KEY),
+            [KEY_CLASS_FINAL] = KEY(KEY_DISPATCH, WAIT_NORMAL),
+        },
+    [WAIT_SKIP_KEY] =
+        {
+            [KEY_CLASS_PRINT] = KEY(KEY_SKIP, WAIT_NORMAL),
+            [KEY_CLASS_CTRL] = KEY(KEY_AGAIN, WAIT_NORMAL),
+            [KEY_CLASS_ESC] = KEY(KEY_START, WAIT_SPEC_KEY),
+            [KEY_CLASS_CSI] = KEY(KEY_SKIP, WAIT_NORMAL),
+            [KEY_CLASS_SS3] = KEY(KEY_SKIP, WAIT_NORMAL),
+            [KEY_CLASS_DIGIT] = KEY(KEY_SKIP, WAIT_SKIP_KEY),
+            [KEY_CLASS_PARAM] = KEY(KEY_SKIP, WAIT_SKIP_KEY),
+            [KEY_CLASS_INTER] = KEY(KEY_SKIP, WAIT_SKIP_KEY),
+            [KEY_CLASS_FINAL] = KEY(KEY_SKIP, WAIT_NORMAL),
+        },
+};
+
+enum key_code {
+    KEY_NONE,
+    KEY_UP,
+    KEY_DOWN,
+    KEY_RIGHT,
+    KEY_LEFT,
+    KEY_HOME,
+    KEY_END,
+    KEY_DELETE,
+    KEY_PASTE_BEGIN,
+    KEY_PASTE_END,
+};
+
+#define KEY_PARAM_ANY   0xFFFF /* the modifiers, e.g. ESC [ 1 ; 5 C, are not used */
+#define KEY_PARAM_FIXED 0x8000 /* set once the first number ends */
+
+/* the sequences with a meaning, ESC [ and ESC O share the letters */
+static const struct {
+    uint8_t final;
+    uint16_t param;
+    uint8_t code;
+} key_codes[] = {
+    {'A', KEY_PARAM_ANY, KEY_UP},    {'B', KEY_PARAM_ANY, KEY_DOWN},   {'C', KEY_PARAM_ANY, KEY_RIGHT},
+    {'D', KEY_PARAM_ANY, KEY_LEFT},  {'H', KEY_PARAM_ANY, KEY_HOME},   {'F', KEY_PARAM_ANY, KEY_END},
+    {'~', 1, KEY_HOME},              {'~', 3, KEY_DELETE},             {'~', 4, KEY_END},
+    {'~', 7, KEY_HOME},              {'~', 8, KEY_END},                {'~', 200, KEY_PASTE_BEGIN},
+    {'~', 201, KEY_PASTE_END},
+};
+
+static uint8_t key_class(uint8_t ch) {
+    if (ch == 0x1b) return KEY_CLASS_ESC;
+    if (ch < 0x20 || ch == 0x7f) return KEY_CLASS_CTRL;
+    if (ch == '[') return KEY_CLASS_CSI;
+    if (ch == 'O') return KEY_CLASS_SS3;
+    if (ch >= '0' && ch <= '9') return KEY_CLASS_DIGIT;
+    if (ch >= ':' && ch <= '?') return KEY_CLASS_PARAM;
+    if (ch >= ' ' && ch <= '/') return KEY_CLASS_INTER;
+    if (ch >= '@' && ch <= '~') return KEY_CLASS_FINAL;
+
+    return KEY_CLASS_PRINT;
+}
 
-    /* normal is echo mode */
-#ifndef FINSH_ECHO_DISABLE_DEFAULT
-    shell->echo_mode = 1;
-#else
-    shell->echo_mode = 0;
+static uint8_t key_lookup(uint8_t final, uint16_t param) {
+    uint32_t i;
+
+    param &= ~KEY_PARAM_FIXED;
+    for (i = 0; i < sizeof(key_codes) / sizeof(key_codes[0]); i++) {
+        if (key_codes[i].final == final && (key_codes[i].param == KEY_PARAM_ANY || key_codes[i].param == param))
+            return key_codes[i].code;
+    }
+
+    return KEY_NONE;
+}
+
+/* move the cursor back from the end of what was just written to line_curpos */
+static void shell_cursor_back(uint16_t from) {
+    uint16_t i;
+
+    for (i = finsh_shell_current->line_curpos; i < from; i++) FINSH_PUTS("\b");
+}
+
+static void shell_exec_line(void) {
+#ifdef FINSH_USING_HISTORY
+    shell_push_history();
+#endif
+    if (finsh_shell_current->echo_mode) FINSH_PUTS("\r\n");
+#ifdef FINSH_USING_TRACE
+    /* from the first key of the line */
+    if (finsh_shell_current->trace_input) FINSH_TRACE_END("input");
+    finsh_shell_current->trace_input = 0;
 #endif
+    msh_exec(finsh_shell_current->line, finsh_shell_current->line_position);
+
+    if (finsh_shell_current->input_hook == NULL)
+        FINSH_PUTS(FINSH_PROMPT);
+    else
+        finsh_shell_current->paste = 0; /* the rest of the input belongs to the hook */
+    FINSH_MEMSET(finsh_shell_current->line, 0, finsh_shell_current->line_size + 1);
+    finsh_shell_current->line_curpos = finsh_shell_current->line_position = 0;
+    finsh_shell_current->paste_from = 0;
+}
 
-#ifdef FINSH_USING_AUTH
-    /* set the default password when the password isn't setting */
-    if (FINSH_STRLEN(finsh_get_password()) == 0) {
-        if (finsh_set_password(FINSH_DEFAULT_PASSWORD) != 0) {
-            FINSH_PRINTF("Finsh password set failed.\r\n");
+static void shell_insert_char(uint8_t ch) {
+    /* received error */
+    if (ch == 0xFF) return;
+
+    /* it's a large line, discard it */
+    if (finsh_shell_current->line_position >= finsh_shell_current->line_size) finsh_shell_current->line_position = 0;
+
+    /* normal character */
+    if (finsh_shell_current->line_curpos < finsh_shell_current->line_position) {
+        FINSH_MEMMOVE(&finsh_shell_current->line[finsh_shell_current->line_curpos + 1],
+                      &finsh_shell_current->line[finsh_shell_current->line_curpos],
+                      finsh_shell_current->line_position - finsh_shell_current->line_curpos);
+        finsh_shell_current->line[finsh_shell_current->line_curpos] = ch;
+        if (finsh_shell_current->echo_mode) {
+            FINSH_PUTS(&finsh_shell_current->line[finsh_shell_current->line_curpos]);
+
+            /* move the cursor to new position */
+            shell_cursor_back(finsh_shell_current->line_position);
         }
+    } else {
+        finsh_shell_current->line[finsh_shell_current->line_position] = ch;
+        if (finsh_shell_current->echo_mode) FINSH_PUTC(ch);
+    }
+
+    finsh_shell_current->line_position++;
+    finsh_shell_current->line_curpos++;
+    if (finsh_shell_current->line_position >= finsh_shell_current->line_size) {
+        /* clear command line */
+        finsh_shell_current->line_position = 0;
+        finsh_shell_current->line_curpos = 0;
+    }
+}
+
+/*
+ * While pasting, the bytes are only stored, the part of the line which is
+ * new is echoed at once at the end of each pasted line and of the paste.
+ * A pasted line longer than the line size is cut.
+ */
+static void shell_paste_char(uint8_t ch) {
+    if (finsh_shell_current->line_position >= finsh_shell_current->line_size) return;
+
+    if (finsh_shell_current->line_curpos < finsh_shell_current->line_position)
+        FINSH_MEMMOVE(&finsh_shell_current->line[finsh_shell_current->line_curpos + 1],
+                      &finsh_shell_current->line[finsh_shell_current->line_curpos],
+                      finsh_shell_current->line_position - finsh_shell_current->line_curpos);
+    finsh_shell_current->line[finsh_shell_current->line_curpos] = ch;
+    finsh_shell_current->line_position++;
+    finsh_shell_current->line_curpos++;
+}
+
+static void shell_paste_flush(void) {
+    if (finsh_shell_current->echo_mode && finsh_shell_current->line_position > finsh_shell_current->paste_from) {
+        finsh_write(&finsh_shell_current->line[finsh_shell_current->paste_from],
+                    finsh_shell_current->line_position - finsh_shell_current->paste_from);
+        shell_cursor_back(finsh_shell_current->line_position);
+    }
+    finsh_shell_current->paste_from = finsh_shell_current->line_curpos;
+}
+
+static void shell_handle_control(uint8_t ch, uint8_t last_cr) {
+    if (ch == '\r' || ch == '\n') {
+        /* "\r\n" is one enter */
+        if (ch == '\n' && last_cr) return;
+        finsh_shell_current->last_cr = ch == '\r';
+
+        if (finsh_shell_current->paste) shell_paste_flush();
+        shell_exec_line();
+        return;
+    }
+
+    if (finsh_shell_current->paste) {
+        /* a tab is pasted as it is rather than completed */
+        if (ch == '\t') shell_paste_char(ch);
+        return;
+    }
+
+#ifdef FINSH_USING_CANCEL
+    /* handle ctrl-c, drop the current line */
+    if (ch == FINSH_KEY_CTRL_C) {
+        FINSH_PUTS("^C\r\n");
+        FINSH_PUTS(FINSH_PROMPT);
+        FINSH_MEMSET(finsh_shell_current->line, 0, finsh_shell_current->line_size + 1);
+        finsh_shell_current->line_curpos = finsh_shell_current->line_position = 0;
+        return;
     }
-    /* waiting authenticate success */
-    finsh_wait_auth();
 #endif
-    FINSH_PRINTF("\r\n");
-    FINSH_PRINTF(FINSH_PROMPT);
 
-    while (1) {
-        ch = (int)shell->get_char();
-        if (ch < 0) {
-            continue;
-        }
+    /* handle tab key */
+    if (ch == '\t') {
+        int i;
+        /* move the cursor to the beginning of line */
+        for (i = 0; i < finsh_shell_current->line_curpos; i++) FINSH_PUTS("\b");
 
-        /*
-         * handle control key
-         * up key  : 0x1b 0x5b 0x41
-         * down key: 0x1b 0x5b 0x42
-         * right key:0x1b 0x5b 0x43
-         * left key: 0x1b 0x5b 0x44
-         */
-        if (ch == 0x1b) {
-            shell->stat = WAIT_SPEC_KEY;
-            continue;
-        } else if (shell->stat == WAIT_SPEC_KEY) {
-            if (ch == 0x5b) {
-                shell->stat = WAIT_FUNC_KEY;
-                continue;
+        /* auto complete */
+        shell_auto_complete(&finsh_shell_current->line[0]);
+        /* re-calculate position */
+        finsh_shell_current->line_curpos = finsh_shell_current->line_position = FINSH_STRLEN(finsh_shell_current->line);
+        return;
+    }
+
+    /* handle backspace key */
+    if (ch == 0x7f || ch == 0x08) {
+        /* note that finsh_shell_current->line_curpos >= 0 */
+        if (finsh_shell_current->line_curpos == 0) return;
+
+        finsh_shell_current->line_position--;
+        finsh_shell_current->line_curpos--;
+
+        if (finsh_shell_current->line_position > finsh_shell_current->line_curpos) {
+            FINSH_MEMMOVE(&finsh_shell_current->line[finsh_shell_current->line_curpos],
+                          &finsh_shell_current->line[finsh_shell_current->line_curpos + 1],
+                          finsh_shell_current->line_position - finsh_shell_current->line_curpos);
+            finsh_shell_current->line[finsh_shell_current->line_position] = 0;
+
+            if (finsh_shell_current->echo_mode) {
+                FINSH_PRINTF("\b%s  \b", &finsh_shell_current->line[finsh_shell_current->line_curpos]);
+
+                /* move the cursor to the origin position */
+                shell_cursor_back(finsh_shell_current->line_position + 1);
             }
+        } else {
+            if (finsh_shell_current->echo_mode) FINSH_PUTS("\b \b");
+            finsh_shell_current->line[finsh_shell_current->line_position] = 0;
+        }
+    }
 
-            shell->stat = WAIT_NORMAL;
-        } else if (shell->stat == WAIT_FUNC_KEY) {
-            shell->stat = WAIT_NORMAL;
+    /* other control characters are dropped */
+}
 
-            if (ch == 0x41) /* up key */
-            {
+static void shell_handle_key(uint8_t code) {
+    switch (code) {
+        case KEY_UP:
 #ifdef FINSH_USING_HISTORY
-                /* prev history */
-                if (shell->current_history > 0)
-                    shell->current_history--;
-                else {
-                    shell->current_history = 0;
-                    continue;
-                }
+            /* prev history */
+            if (finsh_shell_current->current_history > 0)
+                finsh_shell_current->current_history--;
+            else {
+                finsh_shell_current->current_history = 0;
+                break;
+            }
 
-                /* copy the history command */
-                FINSH_MEMCPY(shell->line, &shell->cmd_history[shell->current_history][0], FINSH_CMD_SIZE);
-                shell->line_curpos = shell->line_position = FINSH_STRLEN(shell->line);
-                shell_handle_history(shell);
+            /* copy the history command */
+            FINSH_MEMCPY(finsh_shell_current->line, SHELL_HISTORY(finsh_shell_current->current_history), finsh_shell_current->line_size);
+            finsh_shell_current->line_curpos = finsh_shell_current->line_position = FINSH_STRLEN(finsh_shell_current->line);
+            shell_handle_history();
 #endif
-                continue;
-            } else if (ch == 0x42) /* down key */
-            {
+            break;
+
+        case KEY_DOWN:
 #ifdef FINSH_USING_HISTORY
-                /* next history */
-                if (shell->current_history < shell->history_count - 1)
-                    shell->current_history++;
-                else {
-                    /* set to the end of history */
-                    if (shell->history_count != 0)
-                        shell->current_history = shell->history_count - 1;
-                    else
-                        continue;
-                }
+            /* next history */
+            if (finsh_shell_current->current_history < finsh_shell_current->history_count - 1)
+                finsh_shell_current->current_history++;
+            else {
+                /* set to the end of history */
+                if (finsh_shell_current->history_count != 0)
+                    finsh_shell_current->current_history = finsh_shell_current->history_count - 1;
+                else
+                    break;
+            }
 
-                FINSH_MEMCPY(shell->line, &shell->cmd_history[shell->current_history][0], FINSH_CMD_SIZE);
-                shell->line_curpos = shell->line_position = FINSH_STRLEN(shell->line);
-                shell_handle_history(shell);
+            FINSH_MEMCPY(finsh_shell_current->line, SHELL_HISTORY(finsh_shell_current->current_history), finsh_shell_current->line_size);
+            finsh_shell_current->line_curpos = finsh_shell_current->line_position = FINSH_STRLEN(finsh_shell_current->line);
+            shell_handle_history();
 #endif
-                continue;
-            } else if (ch == 0x44) /* left key */
-            {
-                if (shell->line_curpos) {
-                    FINSH_PRINTF("\b");
-                    shell->line_curpos--;
-                }
+            break;
 
-                continue;
-            } else if (ch == 0x43) /* right key */
-            {
-                if (shell->line_curpos < shell->line_position) {
-                    FINSH_PRINTF("%c", shell->line[shell->line_curpos]);
-                    shell->line_curpos++;
-                }
+        case KEY_LEFT:
+            if (finsh_shell_current->line_curpos) {
+                if (finsh_shell_current->echo_mode) FINSH_PUTS("\b");
+                finsh_shell_current->line_curpos--;
+            }
+            break;
 
-                continue;
+        case KEY_RIGHT:
+            if (finsh_shell_current->line_curpos < finsh_shell_current->line_position) {
+                if (finsh_shell_current->echo_mode) FINSH_PUTC(finsh_shell_current->line[finsh_shell_current->line_curpos]);
+                finsh_shell_current->line_curpos++;
             }
-        }
+            break;
 
-        /* received null or error */
-        if (ch == '\0' || ch == 0xFF) continue;
-        /* handle tab key */
-        else if (ch == '\t') {
-            int i;
-            /* move the cursor to the beginning of line */
-            for (i = 0; i < shell->line_curpos; i++) FINSH_PRINTF("\b");
+        case KEY_HOME:
+            while (finsh_shell_current->line_curpos) {
+                if (finsh_shell_current->echo_mode) FINSH_PUTS("\b");
+                finsh_shell_current->line_curpos--;
+            }
+            break;
+
+        case KEY_END:
+            if (finsh_shell_current->echo_mode)
+                finsh_write(&finsh_shell_current->line[finsh_shell_current->line_curpos],
+                            finsh_shell_current->line_position - finsh_shell_current->line_curpos);
+            finsh_shell_current->line_curpos = finsh_shell_current->line_position;
+            break;
+
+        case KEY_DELETE:
+            if (finsh_shell_current->line_curpos == finsh_shell_current->line_position) break;
+
+            finsh_shell_current->line_position--;
+            FINSH_MEMMOVE(&finsh_shell_current->line[finsh_shell_current->line_curpos],
+                          &finsh_shell_current->line[finsh_shell_current->line_curpos + 1],
+                          finsh_shell_current->line_position - finsh_shell_current->line_curpos);
+            finsh_shell_current->line[finsh_shell_current->line_position] = 0;
+
+            if (finsh_shell_current->echo_mode) {
+                FINSH_PRINTF("%s \b", &finsh_shell_current->line[finsh_shell_current->line_curpos]);
+                shell_cursor_back(finsh_shell_current->line_position);
+            }
+            break;
 
-            /* auto complete */
-            shell_auto_complete(&shell->line[0]);
-            /* re-calculate position */
-            shell->line_curpos = shell->line_position = FINSH_STRLEN(shell->line);
+        case KEY_PASTE_BEGIN:
+            finsh_shell_current->paste = 1;
+            finsh_shell_current->paste_from = finsh_shell_current->line_curpos;
+            break;
 
-            continue;
-        }
-        /* handle backspace key */
-        else if (ch == 0x7f || ch == 0x08) {
-            /* note that shell->line_curpos >= 0 */
-            if (shell->line_curpos == 0) continue;
+        case KEY_PASTE_END:
+            if (finsh_shell_current->paste) shell_paste_flush();
+            finsh_shell_current->paste = 0;
+            break;
+    }
+}
 
-            shell->line_position--;
-            shell->line_curpos--;
+static void shell_handle_input(uint8_t ch) {
+    uint8_t last_cr = finsh_shell_current->last_cr;
+    uint8_t entry;
 
-            if (shell->line_position > shell->line_curpos) {
-                int i;
+    finsh_shell_current->last_cr = 0;
 
-                FINSH_MEMMOVE(&shell->line[shell->line_curpos], &shell->line[shell->line_curpos + 1], shell->line_position - shell->line_curpos);
-                shell->line[shell->line_position] = 0;
+    /* the fast path, a plain character outside of a sequence */
+    if (finsh_shell_current->stat == WAIT_NORMAL && ch >= ' ' && ch < 0x7f) {
+        if (finsh_shell_current->paste)
+            shell_paste_char(ch);
+        else
+            shell_insert_char(ch);
+        return;
+    }
 
-                FINSH_PRINTF("\b%s  \b", &shell->line[shell->line_curpos]);
+    do {
+        entry = key_table[finsh_shell_current->stat][key_class(ch)];
+        finsh_shell_current->stat = (enum input_stat)(entry & 0x0F);
+
+        switch (entry >> 4) {
+            case KEY_INSERT:
+                if (finsh_shell_current->paste)
+                    shell_paste_char(ch);
+                else
+                    shell_insert_char(ch);
+                break;
+            case KEY_CONTROL:
+                /* received null */
+                if (ch != '\0') shell_handle_control(ch, last_cr);
+                break;
+            case KEY_START:
+                finsh_shell_current->key_param = 0;
+                break;
+            case KEY_DIGIT:
+                if (!(finsh_shell_current->key_param & KEY_PARAM_FIXED) && finsh_shell_current->key_param < 1000)
+                    finsh_shell_current->key_param = finsh_shell_current->key_param * 10 + (ch - '0');
+                break;
+            case KEY_SKIP:
+                finsh_shell_current->key_param |= KEY_PARAM_FIXED;
+                break;
+            case KEY_DISPATCH:
+                shell_handle_key(key_lookup(ch, finsh_shell_current->key_param));
+                break;
+        }
+    } while ((entry >> 4) == KEY_AGAIN);
+}
 
-                /* move the cursor to the origin position */
-                for (i = shell->line_curpos; i <= shell->line_position; i++) FINSH_PRINTF("\b");
-            } else {
-                FINSH_PRINTF("\b \b");
-                shell->line[shell->line_position] = 0;
-            }
+void finsh_run(void) {
+    int ch;
 
-            continue;
-        }
+    /* normal is echo mode */
+#ifndef FINSH_ECHO_DISABLE_DEFAULT
+    finsh_shell_current->echo_mode = 1;
+#else
+    finsh_shell_current->echo_mode = 0;
+#endif
 
-        /* handle end of line, break */
-        if (ch == '\r' || ch == '\n') {
-#ifdef FINSH_USING_HISTORY
-            shell_push_history(shell);
+#ifdef FINSH_USING_AUTH
+    /* set the default password when the password isn't setting */
+    if (FINSH_STRLEN(finsh_get_password()) == 0) {
+        if (finsh_set_password(FINSH_DEFAULT_PASSWORD) != 0) {
+            FINSH_PUTS("Finsh password set failed.\r\n");
+        }
+    }
+    /* waiting authenticate success */
+    finsh_wait_auth();
+#endif
+#ifdef FINSH_USING_PASTE
+    /* the terminal wraps pasted text in ESC [ 200 ~ and ESC [ 201 ~ */
+    FINSH_PUTS("\033[?2004h");
 #endif
-            if (shell->echo_mode) FINSH_PRINTF("\r\n");
-            msh_exec(shell->line, shell->line_position);
+    FINSH_PUTS("\r\n");
+    FINSH_PUTS(FINSH_PROMPT);
 
-            FINSH_PRINTF(FINSH_PROMPT);
-            FINSH_MEMSET(shell->line, 0, sizeof(shell->line));
-            shell->line_curpos = shell->line_position = 0;
+    while (1) {
+        ch = (int)finsh_getchar();
+#ifdef FINSH_USING_EOF
+        if (ch == FINSH_GETCHAR_EOF) break;
+#endif
+        if (ch < 0) {
+#ifdef FINSH_USING_LOG
+            finsh_log_drain();
+#endif
+#ifdef FINSH_USING_BULK
+            finsh_bulk_poll();
+#endif
+#ifdef FINSH_USING_ASYNC
+            finsh_async_poll();
+#endif
+#if defined(FINSH_USING_SHM) && defined(__linux__)
+            msh_shm_poll();
+#endif
             continue;
         }
 
-        /* it's a large line, discard it */
-        if (shell->line_position >= FINSH_CMD_SIZE) shell->line_position = 0;
-
-        /* normal character */
-        if (shell->line_curpos < shell->line_position) {
-            int i;
-
-            FINSH_MEMMOVE(&shell->line[shell->line_curpos + 1], &shell->line[shell->line_curpos], shell->line_position - shell->line_curpos);
-            shell->line[shell->line_curpos] = ch;
-            if (shell->echo_mode) FINSH_PRINTF("%s", &shell->line[shell->line_curpos]);
-
-            /* move the cursor to new position */
-            for (i = shell->line_curpos; i < shell->line_position; i++) FINSH_PRINTF("\b");
-        } else {
-            shell->line[shell->line_position] = ch;
-            if (shell->echo_mode) FINSH_PRINTF("%c", ch);
+        if (finsh_shell_current->input_hook) {
+            finsh_shell_current->input_hook((uint8_t)ch);
+            continue;
         }
 
-        ch = 0;
-        shell->line_position++;
-        shell->line_curpos++;
-        if (shell->line_position >= FINSH_CMD_SIZE) {
-            /* clear command line */
-            shell->line_position = 0;
-            shell->line_curpos = 0;
+#ifdef FINSH_USING_TRACE
+        if (!finsh_shell_current->trace_input) {
+            FINSH_TRACE_BEGIN("input");
+            finsh_shell_current->trace_input = 1;
         }
+#endif
+        shell_handle_input((uint8_t)ch);
     } /* end of device read */
+
+#ifdef FINSH_USING_PASTE
+    FINSH_PUTS("\033[?2004l");
+#endif
 }
 
 void finsh_system_function_init(const void *begin, const void *end) {
     _syscall_table_begin = (struct finsh_syscall *)begin;
     _syscall_table_end = (struct finsh_syscall *)end;
+    _syscall_table_sorted = 0;
+}
+
+/**
+ * @ingroup finsh
+ *
+ * This function uses an array of commands sorted by name as the command
+ * table, it is then searched in O(log n), e.g. a table of finsh.hpp.
+ */
+void finsh_system_function_init_sorted(const struct finsh_syscall *begin, const struct finsh_syscall *end) {
+    finsh_system_function_init(begin, end);
+    _syscall_table_sorted = 1;
 }
 
 #if defined(__ICCARM__) || defined(__ICCRX__) /* for IAR compiler */
@@ -475,23 +1497,137 @@ const char __fsym_end_desc[] = "end of finsh";
 __declspec(allocate("FSymTab$z")) const struct finsh_syscall __fsym_end = {__fsym_end_name, __fsym_end_desc, NULL};
 #endif
 
+/* take size bytes from the arena, NULL when it is too small */
+static void *finsh_arena_take(uint8_t **next, uint8_t *end, uint32_t size) {
+    void *block = *next;
+
+    size = FINSH_ARENA_ALIGN(size);
+    if ((uint32_t)(end - *next) < size) return NULL;
+    *next += size;
+
+    return block;
+}
+
+/* carve the shell structure and its buffers out of the arena */
+static int finsh_arena_init(finsh_shell_cfg_t *cfg) {
+    uint8_t *next = (uint8_t *)cfg->arena, *end;
+    uint16_t line_size = cfg->line_size ? cfg->line_size : FINSH_CMD_SIZE;
+    uint16_t prompt_size = cfg->prompt_size ? cfg->prompt_size : FINSH_CONSOLEBUF_SIZE + 1;
+    uint8_t arg_max = cfg->arg_max ? cfg->arg_max : FINSH_ARG_MAX;
+    uint8_t exec_depth = cfg->exec_depth ? cfg->exec_depth : FINSH_EXEC_DEPTH;
+    uint32_t size = cfg->arena_size;
+    struct finsh_shell *carved;
+
+#ifndef FINSH_USING_ARENA
+    if (next == NULL) {
+        next = (uint8_t *)finsh_arena_default;
+        size = sizeof(finsh_arena_default);
+    }
+#endif
+    if (next == NULL || prompt_size < sizeof(_MSH_PROMPT ">")) return -1;
+
+    /* the pointers in the arena must be aligned */
+    end = next + size;
+    while ((uintptr_t)next % sizeof(void *) && next < end) next++;
+
+    carved = (struct finsh_shell *)finsh_arena_take(&next, end, sizeof(struct finsh_shell));
+    if (carved == NULL) return -1;
+    FINSH_MEMSET(carved, 0, sizeof(struct finsh_shell));
+
+    carved->line_size = line_size;
+    carved->line = (char *)finsh_arena_take(&next, end, line_size + 1);
+#ifdef FINSH_USING_HISTORY
+    carved->history_lines = cfg->history_lines ? cfg->history_lines : FINSH_HISTORY_LINES;
+    carved->cmd_history = (char *)finsh_arena_take(&next, end, carved->history_lines * line_size);
+#endif
+    carved->prompt_size = prompt_size;
+    carved->prompt = (char *)finsh_arena_take(&next, end, prompt_size);
+#ifdef FINSH_USING_SCRATCH
+    carved->scratch = (char *)finsh_arena_take(&next, end, 2 * (line_size + 1));
+    carved->scratch_argv = (char **)finsh_arena_take(&next, end, (arg_max + 1) * sizeof(char *));
+    if (carved->scratch == NULL || carved->scratch_argv == NULL) return -1;
+#endif
+#ifdef FINSH_USING_SHM
+    carved->shm_line = (char *)finsh_arena_take(&next, end, line_size + 1);
+    if (carved->shm_line == NULL) return -1;
+#endif
+#ifdef FINSH_USING_ASYNC
+    carved->async_lines = (char *)finsh_arena_take(&next, end, FINSH_ASYNC_MAX * (line_size + 1));
+    carved->async_argv = (char **)finsh_arena_take(&next, end, FINSH_ASYNC_MAX * arg_max * sizeof(char *));
+    if (carved->async_lines == NULL || carved->async_argv == NULL) return -1;
+#endif
+    carved->arg_max = arg_max;
+    carved->exec_depth_max = exec_depth;
+    carved->argv = (char **)finsh_arena_take(&next, end, exec_depth * arg_max * sizeof(char *));
+    if (carved->line == NULL || carved->prompt == NULL || carved->argv == NULL) return -1;
+#ifdef FINSH_USING_HISTORY
+    if (carved->cmd_history == NULL) return -1;
+    FINSH_MEMSET(carved->cmd_history, 0, carved->history_lines * line_size);
+#endif
+    FINSH_MEMSET(carved->line, 0, line_size + 1);
+    FINSH_MEMSET(carved->prompt, 0, prompt_size);
+
+    finsh_shell_current = carved;
+    finsh_arena_size = (uint32_t)(end - (uint8_t *)carved);
+
+    return 0;
+}
+
+/**
+ * @ingroup finsh
+ *
+ * This function reports how the arena of the shell is used.
+ *
+ * @return 0 on OK, -1 before finsh_system_init()
+ */
+int finsh_footprint(struct finsh_footprint *footprint) {
+    if (finsh_shell_current == NULL) return -1;
+
+    FINSH_MEMSET(footprint, 0, sizeof(*footprint));
+    footprint->shell = sizeof(struct finsh_shell);
+    footprint->line = finsh_shell_current->line_size + 1;
+#ifdef FINSH_USING_HISTORY
+    footprint->history = finsh_shell_current->history_lines * finsh_shell_current->line_size;
+#endif
+    footprint->prompt = finsh_shell_current->prompt_size;
+#ifdef FINSH_USING_SCRATCH
+    footprint->scratch = FINSH_ARENA_SCRATCH_BYTES(finsh_shell_current->line_size, finsh_shell_current->arg_max);
+#endif
+    footprint->lines = FINSH_ARENA_SHM_BYTES(finsh_shell_current->line_size) +
+                       FINSH_ARENA_ASYNC_BYTES(finsh_shell_current->line_size, finsh_shell_current->arg_max);
+    footprint->argv = finsh_shell_current->exec_depth_max * finsh_shell_current->arg_max * sizeof(char *);
+    footprint->used = FINSH_ARENA_ALIGN(footprint->shell) + FINSH_ARENA_ALIGN(footprint->line) + FINSH_ARENA_ALIGN(footprint->history) +
+                      FINSH_ARENA_ALIGN(footprint->prompt) + footprint->scratch + footprint->lines + FINSH_ARENA_ALIGN(footprint->argv);
+    footprint->size = finsh_arena_size;
+
+    return 0;
+}
+
 /*
  * @ingroup finsh
  *
- * This function will initialize finsh shell
+ * This function will initialize finsh shell, all its state is carved out
+ * of cfg->arena, nothing is taken from the heap.
+ *
+ * @return 0 on OK, -1 when the arena is too small for the sizes in cfg
  */
 int finsh_system_init(finsh_shell_cfg_t *cfg) {
     if (cfg == NULL) {
         return -1;
     }
 
-    shell = &g_shell;
-    FINSH_MEMSET(shell, 0, sizeof(struct finsh_shell));
-    shell->echo_mode = cfg->echo_mode;
-    shell->prompt_mode = cfg->prompt_mode;
-    shell->get_char = cfg->get_char;
-
-#ifdef __ARMCC_VERSION /* ARM C Compiler */
+    if (finsh_arena_init(cfg) != 0) return -1;
+    finsh_shell_current->echo_mode = cfg->echo_mode;
+    finsh_shell_current->prompt_mode = cfg->prompt_mode;
+    finsh_shell_current->get_char = cfg->get_char;
+    finsh_shell_current->get_tick = cfg->get_tick;
+    finsh_shell_current->get_clock = cfg->clock_hz ? cfg->get_clock : NULL;
+    finsh_shell_current->clock_hz = cfg->clock_hz;
+    finsh_shell_current->output = cfg->output ? cfg->output : finsh_output_default;
+
+#if defined(FINSH_NO_SYMTAB)
+    /* all commands are in the registry */
+#elif defined(__ARMCC_VERSION) /* ARM C Compiler */
     extern const int FSymTab$$Base;
     extern const int FSymTab$$Limit;
     finsh_system_function_init(&FSymTab$$Base, &FSymTab$$Limit);
@@ -507,8 +1643,8 @@ int finsh_system_init(finsh_shell_cfg_t *cfg) {
 #elif defined(_MSC_VER)
     unsigned int *ptr_begin, *ptr_end;
 
-    if (shell) {
-        FINSH_PRINTF("finsh shell already init.\r\n");
+    if (finsh_shell_current) {
+        FINSH_PUTS("finsh shell already init.\r\n");
         return 0;
     }
 
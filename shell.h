@@ -14,6 +14,17 @@
 
 #include "finsh.h"
 
+#include <stdarg.h>
+
+#ifndef FINSH_USING_USER_LIB_FUNC
+#include <stdio.h>
+#include <string.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #ifndef FINSH_CONSOLEBUF_SIZE
 #define FINSH_CONSOLEBUF_SIZE 128
 #endif
@@ -22,11 +33,39 @@
 #define FINSH_CMD_SIZE 80
 #endif
 
-#ifndef FINSH_USING_USER_LIB_FUNC
-#include <stdio.h>
-#include <string.h>
+#ifndef FINSH_ARG_MAX
+#define FINSH_ARG_MAX 8
+#endif /* FINSH_ARG_MAX */
+
+#ifndef FINSH_EXEC_DEPTH
+#define FINSH_EXEC_DEPTH 2 /* msh_exec() running in a command, each level has FINSH_ARG_MAX arguments */
+#endif
+
+#ifdef FINSH_USING_ASYNC
+#ifndef FINSH_ASYNC_MAX
+#define FINSH_ASYNC_MAX 4 /* async commands waiting at once, each keeps a copy of its line */
+#endif
+#endif
+
+/* the completion and bench copy the line and split it, they never run at once */
+#if defined(FINSH_USING_ARGS) || defined(FINSH_USING_COMPLETE) || defined(FINSH_USING_BENCH)
+#define FINSH_USING_SCRATCH
+#endif
+
+typedef void (*finsh_output_t)(const char *buf, uint32_t size);
+typedef void (*finsh_input_hook_t)(uint8_t ch);
 
-#define FINSH_PRINTF(...) printf(__VA_ARGS__)
+int finsh_printf(const char *fmt, ...) FINSH_PRINTF_FORMAT(1, 2);
+int finsh_vsnprintf(char *buf, uint32_t size, const char *fmt, va_list args) FINSH_PRINTF_FORMAT(3, 0);
+void finsh_puts(const char *str);
+void finsh_putc(char ch);
+void finsh_write(const char *buf, uint32_t size);
+finsh_output_t finsh_set_output(finsh_output_t output);
+
+#ifndef FINSH_USING_USER_LIB_FUNC
+#define FINSH_PRINTF(...) finsh_printf(__VA_ARGS__)
+#define FINSH_PUTS        finsh_puts
+#define FINSH_PUTC        finsh_putc
 #define FINSH_MEMSET      memset
 #define FINSH_MEMCPY      memcpy
 #define FINSH_MEMCMP      memcmp
@@ -38,17 +77,78 @@
 #define FINSH_MEMMOVE     memmove
 #endif
 
+#ifndef FINSH_PUTS
+#define FINSH_PUTS(str) FINSH_PRINTF("%s", str)
+#endif
+#ifndef FINSH_PUTC
+#define FINSH_PUTC(ch) FINSH_PRINTF("%c", ch)
+#endif
+
 #define FINSH_OPTION_ECHO 0x01
 
+/* the sessions commands run in, each keeps its own output format and statistics */
+#define FINSH_SESSION_CONSOLE 0
+#define FINSH_SESSION_RPC     1 /* a binary rpc client, see msh_rpc.h */
+#define FINSH_SESSION_SHM     2 /* the clients of the shared memory channel, see msh_shm.h */
+#define FINSH_SESSION_MAX     3
+
+/*
+ * get_char returns -1 when there is no input. With FINSH_USING_EOF it may
+ * return FINSH_GETCHAR_EOF to make finsh_run() return, e.g. at the end of a
+ * script, otherwise that is no input as well and finsh_run() never returns.
+ */
+#define FINSH_GETCHAR_EOF (-2)
+#if defined(FINSH_USING_REPLAY) && !defined(FINSH_USING_EOF)
+#define FINSH_USING_EOF /* finsh_replay() returns at the end of the recording */
+#endif
+
+#ifndef FINSH_TERM_COLUMNS
+#define FINSH_TERM_COLUMNS 80 /* of the terminal, a longer line wraps */
+#endif
+
+#ifndef FINSH_TICK_PER_SECOND
+#define FINSH_TICK_PER_SECOND 1000
+#endif
+
+#ifdef FINSH_USING_CANCEL
+#ifndef FINSH_TYPEAHEAD_SIZE
+#define FINSH_TYPEAHEAD_SIZE 16
+#endif
+
+#define FINSH_KEY_CTRL_C 0x03
+
+/* reasons returned by finsh_cancelled() */
+#define FINSH_CANCEL_NONE    0
+#define FINSH_CANCEL_INTR    1 /* ctrl-c received */
+#define FINSH_CANCEL_TIMEOUT 2 /* per-command deadline expired */
+#endif /* FINSH_USING_CANCEL */
+
+#ifdef FINSH_USING_REGISTRY
+#ifndef FINSH_REGISTRY_MAX
+#define FINSH_REGISTRY_MAX 32
+#endif
+#endif
+
+#ifdef FINSH_USING_COMPLETE
+#ifndef FINSH_COMPLETE_MAX
+#define FINSH_COMPLETE_MAX 8
+#endif
+#ifndef FINSH_COMPLETE_CACHE_SIZE
+#define FINSH_COMPLETE_CACHE_SIZE 256
+#endif
+#endif /* FINSH_USING_COMPLETE */
+
 #define FINSH_PROMPT finsh_get_prompt()
 const char *finsh_get_prompt(void);
 int finsh_set_prompt(const char *prompt);
 
-#ifdef FINSH_USING_HISTORY
+/* output above the line being edited, e.g. logs or a background job */
+void finsh_line_hide(void);
+void finsh_line_show(void);
+
 #ifndef FINSH_HISTORY_LINES
 #define FINSH_HISTORY_LINES 5
 #endif
-#endif
 
 #ifdef FINSH_USING_AUTH
 #ifndef FINSH_PASSWORD_MAX
@@ -62,38 +162,134 @@ int finsh_set_prompt(const char *prompt);
 #endif
 #endif /* FINSH_USING_AUTH */
 
+/* the states of the escape sequence decoder */
 enum input_stat {
     WAIT_NORMAL,
-    WAIT_SPEC_KEY,
-    WAIT_FUNC_KEY,
+    WAIT_SPEC_KEY, /* after ESC */
+    WAIT_FUNC_KEY, /* in a control sequence, ESC [ */
+    WAIT_SS3_KEY,  /* after ESC O */
+    WAIT_SKIP_KEY, /* in a sequence without a meaning, up to its last byte */
 };
 struct finsh_shell {
     enum input_stat stat;
+    uint16_t key_param; /* the first number of a control sequence */
 
     uint8_t echo_mode : 1;
     uint8_t prompt_mode : 1;
+    uint8_t last_cr : 1; /* the last byte was '\r', a '\n' after it is the same enter */
+    uint8_t paste : 1;   /* inside a bracketed paste */
+    uint8_t trace_input : 1; /* the "input" trace span of the line is open, its echo is not traced */
+    uint16_t paste_from; /* the first byte of the line not echoed yet while pasting */
 
 #ifdef FINSH_USING_HISTORY
     uint16_t current_history;
     uint16_t history_count;
+    uint16_t history_lines;
 
-    char cmd_history[FINSH_HISTORY_LINES][FINSH_CMD_SIZE];
+    char *cmd_history; /* history_lines entries of line_size bytes */
 #endif
 
-    char line[FINSH_CMD_SIZE + 1];
+    char *line; /* line_size + 1 bytes */
+    uint16_t line_size;
     uint16_t line_position;
     uint16_t line_curpos;
 
+    char *prompt;
+    uint16_t prompt_size;
+
+#ifdef FINSH_USING_SCRATCH
+    char *scratch;       /* two lines of line_size + 1 bytes */
+    char **scratch_argv; /* arg_max + 1 slots */
+#endif
+
+#ifdef FINSH_USING_SHM
+    char *shm_line; /* line_size + 1 bytes, the line of the shm client */
+#endif
+#ifdef FINSH_USING_ASYNC
+    char *async_lines;  /* FINSH_ASYNC_MAX lines of line_size + 1 bytes */
+    char **async_argv;  /* arg_max slots for each async command */
+#endif
+
+    /* the argv of the running commands, arg_max slots for each level of msh_exec() */
+    char **argv;
+    uint8_t arg_max;
+    uint8_t exec_depth_max;
+    uint8_t exec_depth; /* msh_exec() calls running, more than 1 when a command runs another */
+    uint8_t session;    /* FINSH_SESSION_xxx of the running command */
+
 #ifdef FINSH_USING_AUTH
     char password[FINSH_PASSWORD_MAX];
 #endif
 
+#ifdef FINSH_USING_CANCEL
+    volatile uint8_t cancel; /* FINSH_CANCEL_xxx of the running command */
+    uint8_t deadline_armed;
+    uint32_t deadline;
+
+    /* input read while a command polls for ctrl-c, replayed to the line editor */
+    uint8_t typeahead[FINSH_TYPEAHEAD_SIZE];
+    uint8_t typeahead_head;
+    uint8_t typeahead_count;
+#endif
+
+#ifdef FINSH_USING_COMPLETE
+    /* candidates of the last completed argument, each NUL terminated */
+    uint32_t complete_key; /* hash of the line before the argument, 0 when empty */
+    uint16_t complete_size;
+    char complete_cache[FINSH_COMPLETE_CACHE_SIZE];
+#endif
+
     int (*get_char)(void);
+    uint32_t (*get_tick)(void);
+    uint32_t (*get_clock)(void);
+    uint32_t clock_hz;
+    finsh_output_t output;
+    finsh_input_hook_t input_hook; /* takes all input bytes, e.g. binary modes */
 };
 
+extern struct finsh_shell *finsh_shell_current; /* the shell being run */
+
+/*
+ * All shell state is carved out of one arena, the structure first and then
+ * the buffers sized at run time. FINSH_ARENA_BYTES gives the arena needed
+ * for a configuration, e.g. to size a static array for finsh_system_init().
+ * It has room to align an arena of bytes, which may start anywhere.
+ */
+#define FINSH_ARENA_ALIGN(size) (((size) + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *))
+#ifdef FINSH_USING_HISTORY
+#define FINSH_ARENA_HISTORY_BYTES(line_size, history_lines) FINSH_ARENA_ALIGN((history_lines) * (line_size))
+#else
+#define FINSH_ARENA_HISTORY_BYTES(line_size, history_lines) 0
+#endif
+#ifdef FINSH_USING_SCRATCH
+#define FINSH_ARENA_SCRATCH_BYTES(line_size, arg_max) \
+    (FINSH_ARENA_ALIGN(2 * ((line_size) + 1)) + FINSH_ARENA_ALIGN(((arg_max) + 1) * sizeof(char *)))
+#else
+#define FINSH_ARENA_SCRATCH_BYTES(line_size, arg_max) 0
+#endif
+#ifdef FINSH_USING_SHM
+#define FINSH_ARENA_SHM_BYTES(line_size) FINSH_ARENA_ALIGN((line_size) + 1)
+#else
+#define FINSH_ARENA_SHM_BYTES(line_size) 0
+#endif
+#ifdef FINSH_USING_ASYNC
+#define FINSH_ARENA_ASYNC_BYTES(line_size, arg_max) \
+    (FINSH_ARENA_ALIGN(FINSH_ASYNC_MAX * ((line_size) + 1)) + FINSH_ARENA_ALIGN(FINSH_ASYNC_MAX * (arg_max) * sizeof(char *)))
+#else
+#define FINSH_ARENA_ASYNC_BYTES(line_size, arg_max) 0
+#endif
+#define FINSH_ARENA_BYTES(line_size, history_lines, arg_max, exec_depth, prompt_size)                      \
+    (sizeof(void *) - 1 + FINSH_ARENA_ALIGN(sizeof(struct finsh_shell)) + FINSH_ARENA_ALIGN((line_size) + 1) + \
+     FINSH_ARENA_HISTORY_BYTES(line_size, history_lines) + FINSH_ARENA_ALIGN(prompt_size) +              \
+     FINSH_ARENA_SCRATCH_BYTES(line_size, arg_max) + FINSH_ARENA_SHM_BYTES(line_size) +                  \
+     FINSH_ARENA_ASYNC_BYTES(line_size, arg_max) + FINSH_ARENA_ALIGN((exec_depth) * (arg_max) * sizeof(char *)))
+
 void finsh_set_echo(uint32_t echo);
 uint32_t finsh_get_echo(void);
 
+uint8_t finsh_set_session(uint8_t session);
+uint8_t finsh_get_session(void);
+
 uint32_t finsh_get_prompt_mode(void);
 void finsh_set_prompt_mode(uint32_t prompt_mode);
 
@@ -102,4 +298,20 @@ int finsh_set_password(const char *password);
 const char *finsh_get_password(void);
 #endif
 
+uint32_t finsh_get_tick(void);
+uint32_t finsh_get_clock(void);
+uint32_t finsh_get_clock_hz(void);
+void finsh_set_input_hook(finsh_input_hook_t hook);
+
+#ifdef FINSH_USING_CANCEL
+int finsh_cancelled(void);
+void finsh_cancel(void);
+int finsh_cancel_reset(void);
+int finsh_set_deadline(uint32_t ticks);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the test harness
+ */
+
+/*
+ * A shell driven by a script of keystrokes with its output captured, for
+ * the behavior tests. Each test program includes this header once:
+ *
+ *     test_start(NULL);
+ *     test_keys("help\r");
+ *     TEST_CHECK(test_contains("Shell commands"));
+ *     return test_result();
+ */
+
+#ifndef __FINSH_TEST_H__
+#define __FINSH_TEST_H__
+
+#include <stdio.h>
+#include <string.h>
+
+#include "finsh.h"
+#include "msh.h"
+#include "shell.h"
+
+#define TEST_OUTPUT_SIZE 65536
+
+static const char *test_script;
+static uint32_t test_script_size;
+static uint32_t test_script_pos;
+static int test_idle; /* -1 is returned this many times before the end of the script */
+
+static char test_output[TEST_OUTPUT_SIZE + 1];
+static uint32_t test_output_size;
+
+static int test_failed;
+
+#define TEST_CHECK(cond)                                                                 \
+    do {                                                                                 \
+        if (!(cond)) {                                                                   \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);      \
+            fprintf(stderr, "output: \"%.*s\"\n", (int)test_output_size, test_output);    \
+            test_failed++;                                                               \
+        }                                                                                \
+    } while (0)
+
+#ifndef FINSH_USING_EOF
+#error "the tests end finsh_run() with FINSH_GETCHAR_EOF, define FINSH_USING_EOF"
+#endif
+
+static int test_get_char(void) {
+    if (test_script_pos < test_script_size) return (unsigned char)test_script[test_script_pos++];
+    if (test_idle > 0) {
+        test_idle--;
+        return -1;
+    }
+
+    return FINSH_GETCHAR_EOF;
+}
+
+static void test_capture(const char *buf, uint32_t size) {
+    if (size > TEST_OUTPUT_SIZE - test_output_size) size = TEST_OUTPUT_SIZE - test_output_size;
+    memcpy(test_output + test_output_size, buf, size);
+    test_output_size += size;
+    test_output[test_output_size] = '\0';
+}
+
+static inline void test_clear(void) {
+    test_output_size = 0;
+    test_output[0] = '\0';
+}
+
+/* initialize the shell, cfg may be NULL for the defaults with echo on */
+static inline int test_start(finsh_shell_cfg_t *cfg) {
+    finsh_shell_cfg_t defaults;
+
+    if (cfg == NULL) {
+        memset(&defaults, 0, sizeof(defaults));
+        defaults.echo_mode = 1;
+        defaults.prompt_mode = 1;
+        cfg = &defaults;
+    }
+    cfg->get_char = test_get_char;
+    cfg->output = test_capture;
+    test_clear();
+
+    return finsh_system_init(cfg);
+}
+
+/* feed size keys to the shell and run it until they are used up, each run starts with a new prompt */
+static inline void test_feed(const char *keys, uint32_t size, int idle) {
+    test_script = keys;
+    test_script_size = size;
+    test_script_pos = 0;
+    test_idle = idle;
+    test_clear();
+    finsh_run();
+}
+
+static inline void test_keys(const char *keys) { test_feed(keys, (uint32_t)strlen(keys), 0); }
+
+static inline int test_contains(const char *str) { return strstr(test_output, str) != NULL; }
+
+static inline int test_count(const char *str) {
+    const char *at = test_output;
+    int count = 0;
+
+    while ((at = strstr(at, str)) != NULL) {
+        count++;
+        at += strlen(str);
+    }
+
+    return count;
+}
+
+static inline int test_result(void) {
+    if (test_failed) fprintf(stderr, "%d check(s) failed\n", test_failed);
+
+    return test_failed ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the arena tests
+ */
+
+#include <stdlib.h>
+
+#include "finsh_test.h"
+
+#define LINE_SIZE  160 /* longer than FINSH_CMD_SIZE */
+#define ARG_MAX    12
+#define EXEC_DEPTH 3
+#define ARENA_SIZE FINSH_ARENA_BYTES(LINE_SIZE, 2, ARG_MAX, EXEC_DEPTH, 24)
+
+static uint8_t arena[ARENA_SIZE + 1];
+static int nest_failed;
+
+static int count(int argc, char **argv) {
+    FINSH_PRINTF("%s got %d\r\n", argv[argc - 1], argc);
+    return 0;
+}
+MSH_CMD_EXPORT(count, print the number of arguments);
+
+/* runs itself one level deeper with all argument slots used, its own argv must survive */
+static int nest(int argc, char **argv) {
+    char line[LINE_SIZE + 1];
+    int depth = atoi(argv[1]), i, pos;
+
+    if (depth > 0) {
+        pos = snprintf(line, sizeof(line), "nest %d", depth - 1);
+        for (i = 2; i < ARG_MAX; i++) pos += snprintf(&line[pos], sizeof(line) - pos, " arg%d", i);
+        msh_exec(line, (uint32_t)pos);
+    }
+    if (argc != ARG_MAX || strcmp(argv[ARG_MAX - 1], "arg11") != 0 || atoi(argv[1]) != depth) nest_failed++;
+    FINSH_PRINTF("nest %d\r\n", depth);
+
+    return 0;
+}
+MSH_CMD_EXPORT(nest, run itself nested);
+
+int main(void) {
+    struct finsh_footprint footprint;
+    finsh_shell_cfg_t cfg;
+    char line[LINE_SIZE + 32], bench[LINE_SIZE + 32];
+    int i, pos;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.echo_mode = 1;
+    cfg.prompt_mode = 1;
+    cfg.line_size = LINE_SIZE;
+    cfg.history_lines = 2;
+    cfg.arg_max = ARG_MAX;
+    cfg.exec_depth = EXEC_DEPTH;
+    cfg.prompt_size = 24;
+
+    /* no default arena with FINSH_USING_ARENA */
+    TEST_CHECK(test_start(&cfg) == -1);
+
+    /* the arena may start anywhere, FINSH_ARENA_BYTES has room to align it */
+    cfg.arena = arena + 1;
+    cfg.arena_size = ARENA_SIZE - sizeof(void *);
+    TEST_CHECK(test_start(&cfg) == -1);
+    cfg.arena_size = ARENA_SIZE;
+    TEST_CHECK(test_start(&cfg) == 0);
+
+    TEST_CHECK(finsh_footprint(&footprint) == 0);
+    TEST_CHECK(footprint.line == LINE_SIZE + 1);
+    TEST_CHECK(footprint.history == 2 * LINE_SIZE);
+    TEST_CHECK(footprint.argv == EXEC_DEPTH * ARG_MAX * sizeof(char *));
+    TEST_CHECK(footprint.scratch >= 2 * (LINE_SIZE + 1) + (ARG_MAX + 1) * sizeof(char *));
+    TEST_CHECK(footprint.used <= footprint.size);
+
+    /* a line longer than FINSH_CMD_SIZE with all the arguments */
+    pos = snprintf(line, sizeof(line), "count");
+    for (i = 1; i < ARG_MAX; i++) pos += snprintf(&line[pos], sizeof(line) - pos, " argument-%02d", i);
+    TEST_CHECK(pos > FINSH_CMD_SIZE && pos < LINE_SIZE);
+    snprintf(&line[pos], sizeof(line) - pos, "\r");
+    test_keys(line);
+    TEST_CHECK(test_contains("argument-11 got 12"));
+
+    /* the history keeps the whole line */
+    test_keys("\x1b[A\r");
+    TEST_CHECK(test_contains("argument-11 got 12"));
+
+    /* bench copies a long line as well, the count takes the slots of its options */
+    pos = snprintf(bench, sizeof(bench), "bench -n 2 count");
+    for (i = 1; i < ARG_MAX - 3; i++) pos += snprintf(&bench[pos], sizeof(bench) - pos, " argument-%02d", i);
+    TEST_CHECK(pos > FINSH_CMD_SIZE);
+    snprintf(&bench[pos], sizeof(bench) - pos, "\r");
+    test_keys(bench);
+    TEST_CHECK(!test_contains("arguments too long"));
+    TEST_CHECK(test_count("argument-08 got 9") == 2);
+
+    /* each level of msh_exec() has all the argument slots */
+    pos = snprintf(line, sizeof(line), "nest %d", EXEC_DEPTH - 1);
+    for (i = 2; i < ARG_MAX; i++) pos += snprintf(&line[pos], sizeof(line) - pos, " arg%d", i);
+    snprintf(&line[pos], sizeof(line) - pos, "\r");
+    test_keys(line);
+    TEST_CHECK(nest_failed == 0);
+    TEST_CHECK(test_contains("nest 0\r\nnest 1\r\nnest 2\r\n"));
+    TEST_CHECK(!test_contains("Too many nested commands"));
+
+    /* one level more than the arena has is refused */
+    line[5] = '0' + EXEC_DEPTH;
+    test_keys(line);
+    TEST_CHECK(test_contains("Too many nested commands"));
+
+    return test_result();
+}
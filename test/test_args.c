@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the typed argument tests
+ */
+
+#include "finsh_test.h"
+#include "msh_args.h"
+
+static const char *const modes[] = {"read", "write", NULL};
+
+static union msh_arg_value got[4];
+static uint32_t got_present;
+static int got_calls;
+
+static int mem(const union msh_arg_value *values, uint32_t present) {
+    memcpy(got, values, sizeof(got));
+    got_present = present;
+    got_calls++;
+
+    return 0;
+}
+MSH_CMD_EXPORT_ARGS(mem, access memory, MSH_ARG_ENUM("mode", modes), MSH_ARG_HEX("addr"), MSH_ARG_OPTIONAL,
+                    MSH_ARG_INT("count", 1, 256), MSH_ARG_FLAG("-v"));
+
+static void run(const char *line) {
+    char keys[128];
+
+    snprintf(keys, sizeof(keys), "%s\r", line);
+    got_calls = 0;
+    got_present = 0;
+    memset(got, 0, sizeof(got));
+    test_keys(keys);
+}
+
+int main(void) {
+    test_start(NULL);
+
+    run("mem write 0x20001000 16 -v");
+    TEST_CHECK(got_calls == 1);
+    TEST_CHECK(got[0].index == 1);
+    TEST_CHECK(got[1].u == 0x20001000UL);
+    TEST_CHECK(got[2].i == 16);
+    TEST_CHECK(got[3].index == 1);
+    TEST_CHECK(got_present == 0xF);
+
+    /* the flag may come first, optional values may be left out */
+    run("mem -v read 1f");
+    TEST_CHECK(got_calls == 1);
+    TEST_CHECK(got[0].index == 0);
+    TEST_CHECK(got[1].u == 0x1f);
+    TEST_CHECK(got_present == 0xB);
+
+    run("mem read 0 257");
+    TEST_CHECK(got_calls == 0);
+    TEST_CHECK(test_contains("mem: invalid count '257'"));
+    TEST_CHECK(test_contains("Usage: mem <read|write> <addr:hex> [count:1..256] [-v]"));
+
+    run("mem erase 0");
+    TEST_CHECK(got_calls == 0);
+    TEST_CHECK(test_contains("mem: invalid mode 'erase'"));
+
+    run("mem read 0xZZ");
+    TEST_CHECK(got_calls == 0);
+    TEST_CHECK(test_contains("mem: invalid addr '0xZZ'"));
+
+    run("mem read");
+    TEST_CHECK(got_calls == 0);
+    TEST_CHECK(test_contains("mem: missing addr"));
+
+    run("mem read 0 1 extra");
+    TEST_CHECK(got_calls == 0);
+    TEST_CHECK(test_contains("mem: unexpected argument 'extra'"));
+
+    run("mem -h");
+    TEST_CHECK(got_calls == 0);
+    TEST_CHECK(test_contains("Usage: mem "));
+    TEST_CHECK(!test_contains("missing"));
+
+    /* the choices of an enum and the flags are completed */
+    test_keys("mem wr\t");
+    TEST_CHECK(strcmp(finsh_shell_current->line, "mem write") == 0);
+    test_keys("\x03");
+
+    return test_result();
+}
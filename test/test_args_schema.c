@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the schema size check
+ */
+
+/*
+ * Only compiled: with FINSH_ARGS_SCHEMA_MAX=2 a schema of two entries
+ * builds and, with OVERSIZED, one of three does not.
+ */
+
+#include "msh_args.h"
+
+static int two(const union msh_arg_value *values, uint32_t present) {
+    (void)values;
+    return (int)present;
+}
+MSH_CMD_EXPORT_ARGS(two, fits, MSH_ARG_HEX("addr"), MSH_ARG_FLAG("-v"));
+
+#ifdef OVERSIZED
+static int three(const union msh_arg_value *values, uint32_t present) {
+    (void)values;
+    return (int)present;
+}
+MSH_CMD_EXPORT_ARGS(three, too long, MSH_ARG_HEX("addr"), MSH_ARG_OPTIONAL, MSH_ARG_FLAG("-v"));
+#endif
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the async command tests
+ */
+
+#include <stdlib.h>
+
+#include "finsh_test.h"
+#include "msh_async.h"
+
+#define STEPS 3
+
+static char order[64]; /* the id of each step, in the order they ran */
+static int order_size;
+static int released;
+
+/* takes STEPS turns, then waits until release is typed */
+static int worker(struct finsh_async *ctx) {
+    FINSH_ASYNC_BEGIN(ctx);
+
+    for (ctx->locals[0] = 0; ctx->locals[0] < STEPS; ctx->locals[0]++) {
+        order[order_size++] = ctx->argv[1][0];
+        FINSH_ASYNC_YIELD(ctx);
+    }
+    FINSH_ASYNC_WAIT_UNTIL(ctx, released);
+    FINSH_ASYNC_EXIT(ctx, atoi(ctx->argv[1]));
+
+    FINSH_ASYNC_END(ctx);
+}
+MSH_ASYNC_CMD_EXPORT(worker, step and wait);
+
+static int release(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+
+    released = 1;
+    return 0;
+}
+MSH_CMD_EXPORT(release, let the workers finish);
+
+#define LINE_SIZE 160 /* longer than FINSH_CMD_SIZE */
+#define ARG_MAX   12
+
+static void *arena[FINSH_ARENA_BYTES(LINE_SIZE, FINSH_HISTORY_LINES, ARG_MAX, FINSH_EXEC_DEPTH, FINSH_CONSOLEBUF_SIZE + 1) /
+                   sizeof(void *)];
+
+/* prints its last argument and their number after a turn, when the shell line is long gone */
+static int count(struct finsh_async *ctx) {
+    FINSH_ASYNC_BEGIN(ctx);
+
+    FINSH_ASYNC_YIELD(ctx);
+    FINSH_PRINTF("%s got %d\r\n", ctx->argv[ctx->argc - 1], ctx->argc);
+
+    FINSH_ASYNC_END(ctx);
+}
+MSH_ASYNC_CMD_EXPORT(count, count the arguments later);
+
+static uint32_t now;
+
+static uint32_t test_tick(void) { return now; }
+
+/* sleeps for as many ticks as its argument */
+static int nap(struct finsh_async *ctx) {
+    FINSH_ASYNC_BEGIN(ctx);
+
+    FINSH_ASYNC_SLEEP(ctx, (uint32_t)atoi(ctx->argv[1]));
+    FINSH_ASYNC_EXIT(ctx, 7);
+
+    FINSH_ASYNC_END(ctx);
+}
+MSH_ASYNC_CMD_EXPORT(nap, sleep for some ticks);
+
+int main(void) {
+    finsh_shell_cfg_t cfg;
+    char line[64], longline[LINE_SIZE + 1];
+    char *argv[FINSH_ARG_MAX + 1];
+    int i, pos;
+
+    test_start(NULL);
+
+    /* all the commands wait on the one shell thread, the prompt stays usable */
+    test_keys("worker 1\rworker 2\rworker 3\rworker 4\r");
+    TEST_CHECK(test_contains("[1] worker"));
+    TEST_CHECK(test_contains("[4] worker"));
+    TEST_CHECK(order_size == 4);
+    test_keys("worker 5\r");
+    TEST_CHECK(test_contains("worker: too many async commands."));
+
+    /* each poll resumes every command once, so their steps interleave */
+    test_feed("", 0, STEPS);
+    TEST_CHECK(order_size == 4 * STEPS);
+    TEST_CHECK(memcmp(order, "123412341234", 12) == 0);
+    test_keys("jobs\r");
+    TEST_CHECK(test_count("Waiting") == 4);
+    TEST_CHECK(!test_contains("Done"));
+
+    /* the commands finish above the half-typed line, which is drawn again */
+    test_keys("release\rhel");
+    test_feed("", 0, 1);
+    for (i = 1; i <= 4; i++) {
+        snprintf(line, sizeof(line), "[%d] Done worker: %d\r\n%shel", i, i, FINSH_PROMPT);
+        TEST_CHECK(test_contains(line));
+    }
+    test_keys("\x03jobs\r");
+    TEST_CHECK(!test_contains("Waiting"));
+
+    /* arguments which do not fit the context are an error, not cut */
+    for (i = 0; i <= FINSH_ARG_MAX; i++) argv[i] = "1";
+    test_clear();
+    TEST_CHECK(finsh_async_spawn(worker, "worker", FINSH_ARG_MAX + 1, argv) == -1);
+    TEST_CHECK(test_contains("worker: too many arguments."));
+    memset(line, 'x', sizeof(line) - 1);
+    line[sizeof(line) - 1] = '\0';
+    argv[1] = line;
+    argv[2] = line;
+    TEST_CHECK(finsh_async_spawn(worker, "worker", 3, argv) == -1);
+    TEST_CHECK(test_contains("worker: arguments too long."));
+
+    /* a sleep which nothing can wake fails at once */
+    test_clear();
+    test_keys("nap 5\rjobs\r");
+    TEST_CHECK(test_contains("nap: no tick source to sleep on."));
+    TEST_CHECK(!test_contains("[1] nap"));
+    TEST_CHECK(!test_contains("Sleeping"));
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.echo_mode = 1;
+    cfg.prompt_mode = 1;
+    cfg.get_tick = test_tick;
+    test_start(&cfg);
+    test_keys("nap 5\r");
+    TEST_CHECK(test_contains("[1] nap"));
+    now = 4;
+    test_feed("", 0, 1);
+    TEST_CHECK(!test_contains("Done"));
+    now = 5;
+    test_feed("", 0, 1);
+    TEST_CHECK(test_contains("[1] Done nap: 7"));
+
+    /* the copy of the line is as long as the line of the shell */
+    cfg.arena = arena;
+    cfg.arena_size = sizeof(arena);
+    cfg.line_size = LINE_SIZE;
+    cfg.arg_max = ARG_MAX;
+    TEST_CHECK(test_start(&cfg) == 0);
+    pos = snprintf(longline, sizeof(longline), "count");
+    for (i = 1; i < ARG_MAX; i++) pos += snprintf(&longline[pos], sizeof(longline) - pos, " argument-%02d", i);
+    TEST_CHECK(pos > FINSH_CMD_SIZE);
+    snprintf(&longline[pos], sizeof(longline) - pos, "\r");
+    test_keys(longline);
+    TEST_CHECK(test_contains("[1] count"));
+    test_keys("jobs\r");
+    test_feed("", 0, 1);
+    TEST_CHECK(test_contains("argument-11 got 12"));
+    TEST_CHECK(test_contains("[1] Done count: 0"));
+
+    return test_result();
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the bench tests
+ */
+
+#include "finsh_test.h"
+
+static uint32_t clock_now;
+static int runs, changed;
+
+/* a 1 GHz clock which advances 100 ns each time it is read */
+static uint32_t test_clock(void) { return clock_now += 100; }
+
+/* changes its arguments, each run must see them as typed */
+static int mangle(int argc, char **argv) {
+    if (argc != 3 || argv[1][0] != 'a' || argv[2] == NULL || argv[2][0] != 'b') changed++;
+    argv[1][0] = 'x';
+    argv[2] = NULL;
+    runs++;
+    return 0;
+}
+MSH_CMD_EXPORT(mangle, change the arguments);
+
+static int fail3(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    return ++runs == 3 ? 5 : 0;
+}
+MSH_CMD_EXPORT(fail3, fail on the third run);
+
+int main(void) {
+    finsh_shell_cfg_t cfg;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.echo_mode = 1;
+    cfg.prompt_mode = 1;
+    cfg.get_clock = test_clock;
+    cfg.clock_hz = 1000000000;
+    test_start(&cfg);
+
+    /* each run gets a fresh copy of the arguments */
+    test_keys("bench -n 10 mangle abc bcd\r");
+    TEST_CHECK(runs == 10);
+    TEST_CHECK(changed == 0);
+    TEST_CHECK(test_contains("mangle: 10 runs, min 0 mean 0 p50 0 p99 0 max 0 ns (overhead 100 ns)"));
+
+    /* a failed run ends the benchmark with its return code */
+    runs = 0;
+    test_keys("bench -n 10 fail3\r");
+    TEST_CHECK(runs == 3);
+    TEST_CHECK(test_contains("fail3: run 3 returned 5"));
+    TEST_CHECK(!test_contains("10 runs"));
+    runs = 0;
+    test_keys("bench -w 5 -n 10 fail3\r");
+    TEST_CHECK(runs == 3);
+    TEST_CHECK(test_contains("fail3: run 3 returned 5"));
+
+    test_keys("time mangle abc bcd\r");
+    TEST_CHECK(test_contains("mangle: 0 ns, returned 0"));
+
+    /* bench keeps one copy of the arguments, it does not nest */
+    runs = 0;
+    test_clear();
+    test_keys("bench -n 2 bench -n 2 mangle abc\r");
+    TEST_CHECK(test_contains("bench: bench is already running."));
+    TEST_CHECK(test_contains("bench: run 1 returned -1"));
+    TEST_CHECK(runs == 0);
+    test_clear();
+    test_keys("bench -n 2 time mangle abc\r");
+    TEST_CHECK(test_contains("time: bench is already running."));
+    TEST_CHECK(runs == 0);
+    test_keys("bench -n 10 mangle abc bcd\r");
+    TEST_CHECK(runs == 10);
+    TEST_CHECK(changed == 0);
+
+    /* the tick without a tick source is too coarse, nothing below it is reported */
+    cfg.get_clock = NULL;
+    cfg.clock_hz = 0;
+    test_start(&cfg);
+    test_keys("bench -n 1000 mangle abc bcd\r");
+    TEST_CHECK(test_contains("mangle: 1000 runs took under 10 ticks of 1000000 ns"));
+    TEST_CHECK(!test_contains("p50"));
+    test_keys("time mangle abc bcd\r");
+    TEST_CHECK(test_contains("mangle: under 10000000 ns, returned 0"));
+
+    return test_result();
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the cancel tests
+ */
+
+#include <stdlib.h>
+
+#include "finsh_test.h"
+
+static uint32_t fake_tick;
+static int spins;
+
+/* each read of the tick moves time on by one tick */
+static uint32_t test_tick(void) { return fake_tick++; }
+
+static int nop(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+
+    return 0;
+}
+MSH_CMD_EXPORT(nop, do nothing);
+
+static int intr(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+
+    finsh_cancel();
+    return 0;
+}
+MSH_CMD_EXPORT(intr, act as ctrl-c);
+
+/* runs another command, then spins until it is stopped */
+static int outer(int argc, char **argv) {
+    if (argc != 2) return -1;
+
+    msh_exec(argv[1], FINSH_STRLEN(argv[1]));
+    for (spins = 0; spins < 100000; spins++) {
+        if (finsh_cancelled()) return -1;
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(outer, run a command and spin);
+
+/* polls count times, a tick passes on each poll */
+static int spin(int argc, char **argv) {
+    int count;
+
+    if (argc != 2) return -1;
+
+    for (count = atoi(argv[1]); count > 0; count--) {
+        if (finsh_cancelled()) return -1;
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(spin, poll a number of times);
+
+int main(void) {
+    finsh_shell_cfg_t cfg;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.echo_mode = 1;
+    cfg.prompt_mode = 1;
+    cfg.get_tick = test_tick;
+    test_start(&cfg);
+
+    /* the nested msh_exec() keeps the deadline of timeout */
+    test_keys("timeout 100ms outer nop\r");
+    TEST_CHECK(test_contains("outer: timed out"));
+    TEST_CHECK(spins < 100000);
+
+    /* and a ctrl-c */
+    test_keys("outer intr\r");
+    TEST_CHECK(spins == 0);
+    TEST_CHECK(test_contains("^C"));
+
+    /* the state is cleared for the next command */
+    test_keys("outer nop\r");
+    TEST_CHECK(spins == 100000);
+
+    /* a timeout inside a longer one ends the inner command only */
+    test_clear();
+    test_keys("timeout 1000ms timeout 50ms spin 100\r");
+    TEST_CHECK(test_count("timed out") == 1);
+    TEST_CHECK(test_contains("spin: timed out"));
+
+    /* each run under bench gets a deadline of its own */
+    test_clear();
+    test_keys("bench -n 5 timeout 100ms spin 40\r");
+    TEST_CHECK(!test_contains("timed out"));
+    TEST_CHECK(test_contains("timeout: 5 runs"));
+
+    /* durations whose ticks do not fit are rejected */
+    test_keys("timeout 4294967295m nop\r");
+    TEST_CHECK(test_contains("timeout: invalid duration '4294967295m'"));
+    test_keys("timeout 35792m nop\r");
+    TEST_CHECK(test_contains("timeout: invalid duration"));
+    test_keys("timeout 35791m nop\r");
+    TEST_CHECK(!test_contains("invalid"));
+
+    return test_result();
+}
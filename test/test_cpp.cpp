@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the C++ wrapper tests
+ */
+
+#include "finsh_test.h"
+#include "finsh.hpp"
+
+static int zeta(int argc, char **argv) {
+    (void)argv;
+    finsh_printf("zeta %d\r\n", argc);
+    return 0;
+}
+
+static int alpha(int argc, char **argv) {
+    (void)argc;
+    finsh_printf("alpha %s\r\n", argv[0]);
+    return 0;
+}
+
+static int mid(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    return 3;
+}
+
+static constexpr auto table = finsh::make_table({
+    {"zeta", "Last.", zeta},
+    {"alpha", "First.", alpha},
+    {"mid", "Middle.", mid},
+});
+
+static_assert(finsh::detail::compare(table[0].name, "alpha") == 0, "the table is sorted at compile time");
+static_assert(finsh::detail::compare(table[1].name, "mid") == 0, "the table is sorted at compile time");
+static_assert(finsh::detail::compare(table[2].name, "zeta") == 0, "the table is sorted at compile time");
+
+/* the formats are checked at compile time by the rules of the formatter of the shell */
+static_assert(finsh::detail::check_format("%s %d %-8lu %p %%\r\n", finsh::detail::Types<const char *, int, unsigned long, void *>()),
+              "matching arguments");
+static_assert(finsh::detail::check_format("%*s %zu", decltype(finsh::detail::types(4, "x", sizeof(int)))()), "width and size");
+static_assert(!finsh::detail::check_format("%d", finsh::detail::Types<const char *>()), "a string for an integer");
+static_assert(!finsh::detail::check_format("%ld", finsh::detail::Types<int>()), "an int for a long");
+static_assert(!finsh::detail::check_format("%s %s", finsh::detail::Types<const char *>()), "too few arguments");
+static_assert(!finsh::detail::check_format("%s", finsh::detail::Types<const char *, int>()), "too many arguments");
+#ifndef FINSH_USING_LIBC_PRINTF
+static_assert(!finsh::detail::check_format("%f", finsh::detail::Types<double>()), "no floats in the formatter of the shell");
+#endif
+
+int main(void) {
+    finsh_shell_cfg_t cfg;
+    int calls = 0;
+
+    /* a shell to come back to */
+    test_start(NULL);
+    struct finsh_shell *outer = finsh_shell_current;
+
+    {
+        memset(&cfg, 0, sizeof(cfg));
+        cfg.echo_mode = 1;
+        cfg.prompt_mode = 1;
+        cfg.get_char = test_get_char;
+        cfg.output = test_capture;
+
+        finsh::Shell shell(cfg);
+        TEST_CHECK(shell.ready());
+        TEST_CHECK(finsh_shell_current != outer);
+        shell.use(table);
+        TEST_CHECK(_syscall_table_sorted == 1);
+        TEST_CHECK(_syscall_table_begin == table.calls && _syscall_table_end == table.calls + table.size());
+
+        TEST_CHECK(shell.add("count", "Count the calls.", [&](int argc, char **argv) {
+            (void)argv;
+            calls += argc;
+            return calls;
+        }));
+        TEST_CHECK(!shell.add("count", "Taken.", [](int, char **) { return 0; }));
+
+        test_keys("alpha\rzeta 1 2\rmid\rnope\rcount x\r");
+        TEST_CHECK(test_contains("alpha alpha\r\n"));
+        TEST_CHECK(test_contains("zeta 3\r\n"));
+        TEST_CHECK(test_contains("nope: command not found."));
+        TEST_CHECK(calls == 2);
+        TEST_CHECK(shell.exec("count") == 3);
+        TEST_CHECK(shell.exec("mid") == 3);
+
+        test_clear();
+        FINSH_CHECKED_PRINTF("%s=%d\r\n", "calls", calls);
+        FINSH_CHECKED_PRINTF("done\r\n");
+        TEST_CHECK(test_contains("calls=3\r\ndone\r\n"));
+
+        {
+            auto scoped = finsh::make_command("scoped", "Gone at the end of the block.", [](int, char **) { return 7; });
+            TEST_CHECK(scoped->registered());
+            TEST_CHECK(shell.exec("scoped") == 7);
+        }
+        TEST_CHECK(msh_cmd_find("scoped", 6) == NULL);
+    }
+
+    /* the commands, the table and the shell are gone */
+    TEST_CHECK(finsh_shell_current == outer);
+    TEST_CHECK(_syscall_table_sorted == 0);
+    TEST_CHECK(msh_cmd_find("count", 5) == NULL);
+    test_keys("alpha\r");
+    TEST_CHECK(test_contains("alpha: command not found."));
+    test_keys("help\r");
+    TEST_CHECK(test_contains("shell commands"));
+
+    return test_result();
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the input decoder tests
+ */
+
+#include "finsh_test.h"
+
+/* the line the shell ran, as msh reports an unknown command */
+static int ran(const char *line) {
+    char found[FINSH_CMD_SIZE + 32];
+
+    snprintf(found, sizeof(found), "%s: command not found.", line);
+    return test_contains(found);
+}
+
+/* turns the echo off, the rest of the input is not echoed */
+static int quiet(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    finsh_set_echo(0);
+    return 0;
+}
+MSH_CMD_EXPORT(quiet, turn the echo off);
+
+int main(void) {
+    char line[FINSH_CMD_SIZE + 32];
+
+    test_start(NULL);
+
+    /* Home, in the forms of different terminals */
+    test_keys("abc\x1b[Hx\r");
+    TEST_CHECK(ran("xabc"));
+    test_keys("abc\x1b[1~x\r");
+    TEST_CHECK(ran("xabc"));
+    test_keys("abc\x1bOHx\r");
+    TEST_CHECK(ran("xabc"));
+
+    /* End and Delete */
+    test_keys("abc\x1b[D\x1b[D\x1b[Fx\r");
+    TEST_CHECK(ran("abcx"));
+    test_keys("abc\x1b[D\x1b[D\x1b[4~x\r");
+    TEST_CHECK(ran("abcx"));
+    test_keys("abc\x1b[D\x1b[D\x1b[3~\r");
+    TEST_CHECK(ran("ac"));
+    test_keys("abc\x1b[3~\r");
+    TEST_CHECK(ran("abc"));
+
+    /* the modifiers of CSI and SS3 sequences are not used */
+    test_keys("abc\x1b[1;5Dx\r");
+    TEST_CHECK(ran("abxc"));
+    test_keys("abc\x1bO5Dx\r");
+    TEST_CHECK(ran("abxc"));
+
+    /* sequences without a meaning are dropped as a whole */
+    test_keys("ab\x1b[99~\x1b[2J\x1b[[A\x1bO5Z\x1b[?25hc\r");
+    TEST_CHECK(ran("abc"));
+
+    /* "\r\n" is one enter, "\n" alone is one too */
+    test_keys("nope\r\nnope\n");
+    TEST_CHECK(test_count("nope: command not found.") == 2);
+    snprintf(line, sizeof(line), "%s%s", FINSH_PROMPT, FINSH_PROMPT);
+    TEST_CHECK(!test_contains(line));
+
+    /* a paste is echoed at its end, its tab is not completed */
+    test_keys("x\x1b[D\x1b[200~ab\tc\x1b[201~\r");
+    TEST_CHECK(test_contains("x\bab\tcx\b\r\n"));
+    TEST_CHECK(test_count("ab\tcx") == 2);
+    test_keys("\x1b[200~nope1\rnope2\r\x1b[201~");
+    TEST_CHECK(ran("nope1"));
+    TEST_CHECK(ran("nope2"));
+
+    /* nothing is written while editing without echo */
+    test_keys("quiet\rabc\x1b[D\x1b[D\x1b[3~\x7f\x1b[H\x1b[C\x1b[F\x1b[Dx\r");
+    snprintf(line, sizeof(line), "%sxc: command not found.", FINSH_PROMPT);
+    TEST_CHECK(test_contains(line));
+
+    return test_result();
+}
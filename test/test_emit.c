@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the structured output tests
+ */
+
+#include "finsh_test.h"
+#include "msh_emit.h"
+
+static int rec(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+
+    finsh_emit_begin();
+    finsh_emit_str("name", "led", "%-6s");
+    finsh_emit_uint("size", 42, "[%4lu]");
+    finsh_emit_int("temp", -3, "%d"); /* no 'l', prints key=value */
+    finsh_emit_bool("on", 1, "%s %s");
+    finsh_emit_end("\r\n");
+    return 0;
+}
+MSH_CMD_EXPORT(rec, emit a test record);
+
+int main(void) {
+    uint8_t session;
+
+    test_start(NULL);
+
+    test_keys("rec\r");
+    TEST_CHECK(test_contains("led   [  42]temp=-3 on=true \r\n"));
+
+    /* a client switching its own session leaves the console in text */
+    session = finsh_set_session(FINSH_SESSION_RPC);
+    TEST_CHECK(session == FINSH_SESSION_CONSOLE);
+    TEST_CHECK(finsh_emit_set_format(FINSH_EMIT_JSON) == 0);
+    TEST_CHECK(finsh_emit_get_format() == FINSH_EMIT_JSON);
+    TEST_CHECK(finsh_emit_set_format(FINSH_EMIT_CBOR + 1) == -1);
+    TEST_CHECK(finsh_emit_set_format(-1) == -1);
+    TEST_CHECK(finsh_emit_get_format() == FINSH_EMIT_JSON);
+    finsh_set_session(session);
+    TEST_CHECK(finsh_emit_get_format() == FINSH_EMIT_TEXT);
+
+    test_clear();
+    test_keys("format\r");
+    TEST_CHECK(test_contains("text\r\n"));
+    test_keys("rec\r");
+    TEST_CHECK(test_contains("led   [  42]"));
+    TEST_CHECK(!test_contains("{\"name\""));
+
+    /* and the other way round */
+    test_keys("format json\r");
+    test_clear();
+    test_keys("rec\r");
+    TEST_CHECK(test_contains("{\"name\":\"led\",\"size\":42,\"temp\":-3,\"on\":true}\r\n"));
+    finsh_set_session(FINSH_SESSION_RPC);
+    TEST_CHECK(finsh_emit_get_format() == FINSH_EMIT_JSON);
+    finsh_set_session(FINSH_SESSION_SHM);
+    TEST_CHECK(finsh_emit_get_format() == FINSH_EMIT_TEXT);
+    finsh_set_session(FINSH_SESSION_CONSOLE);
+
+    return test_result();
+}
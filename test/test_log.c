@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the log sink tests
+ */
+
+#include "finsh_test.h"
+#include "msh_log.h"
+
+/* turns the echo off and logs, e.g. a command reading a password */
+static int quiet(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    finsh_set_echo(0);
+    finsh_log_printf("quiet");
+    return 0;
+}
+MSH_CMD_EXPORT(quiet, log without echo);
+
+int main(void) {
+    uint32_t written, dropped, truncated;
+    char line[FINSH_LOG_LINE_MAX + 16];
+    int i;
+
+    test_start(NULL);
+
+    /* the logs are written above the half-typed line, which is drawn again */
+    test_keys("hel");
+    TEST_CHECK(finsh_log_printf("boot %d", 1) == 0);
+    TEST_CHECK(finsh_log_write("ready\n", 6) == 0);
+    test_feed("p", 1, 1);
+    TEST_CHECK(test_contains("boot 1\r\n"));
+    TEST_CHECK(test_contains("ready\n"));
+    TEST_CHECK(strstr(test_output, "ready\n") > strstr(test_output, "boot 1"));
+    snprintf(line, sizeof(line), "%shel", FINSH_PROMPT);
+    TEST_CHECK(test_contains(line));
+    test_feed("\r", 1, 0);
+    TEST_CHECK(test_contains("shell commands"));
+
+    /* a line wrapped by the terminal is cleared from its first row */
+    memset(line, 'w', FINSH_TERM_COLUMNS);
+    test_feed(line, FINSH_TERM_COLUMNS - 2, 0);
+    finsh_log_printf("wrapped");
+    test_feed("", 0, 1);
+    TEST_CHECK(test_contains("\x1b[1A\r\x1b[Jwrapped\r\n"));
+    test_feed("\x03\r", 2, 0);
+
+    /* without echo the logs are written as they are */
+    test_feed("quiet\r", 6, 1);
+    TEST_CHECK(test_contains("quiet\r\n"));
+    TEST_CHECK(!test_contains("\x1b[J"));
+
+    /* the bytes of a paste are echoed once, at its end */
+    test_feed("\x1b[200~abc", 9, 0);
+    finsh_log_printf("pasting");
+    test_feed("def", 3, 1);
+    TEST_CHECK(test_contains("\r\x1b[Jpasting\r\n"));
+    TEST_CHECK(!test_contains("abc"));
+    test_feed("\x1b[201~", 6, 0);
+    TEST_CHECK(test_count("abcdef") == 1);
+    test_feed("\x03\r", 2, 0);
+
+    /* nothing is drawn when the ring is empty */
+    test_feed("", 0, 0);
+    i = (int)test_output_size;
+    test_feed("", 0, 3);
+    TEST_CHECK(test_output_size == (uint32_t)i);
+
+    /* a full ring drops, the drained slots are used again */
+    for (i = 0; i < FINSH_LOG_SLOTS + 3; i++) finsh_log_printf("msg %d", i);
+    finsh_log_counters(&written, &dropped, &truncated);
+    TEST_CHECK(written == 5 + FINSH_LOG_SLOTS);
+    TEST_CHECK(dropped == 3);
+    test_feed("", 0, 1);
+    TEST_CHECK(test_count("msg ") == FINSH_LOG_SLOTS);
+    TEST_CHECK(test_contains("msg 0\r\n"));
+    snprintf(line, sizeof(line), "msg %d", FINSH_LOG_SLOTS);
+    TEST_CHECK(!test_contains(line));
+    TEST_CHECK(finsh_log_printf("again") == 0);
+    test_feed("", 0, 1);
+    TEST_CHECK(test_contains("again"));
+
+    /* long messages are cut */
+    memset(line, 'x', sizeof(line));
+    TEST_CHECK(finsh_log_write(line, sizeof(line)) == 0);
+    test_feed("", 0, 1);
+    finsh_log_counters(&written, &dropped, &truncated);
+    TEST_CHECK(truncated == 1);
+    TEST_CHECK(test_count("x") == FINSH_LOG_LINE_MAX);
+    line[sizeof(line) - 1] = '\0';
+    TEST_CHECK(finsh_log_printf("%s", line) == 0);
+    test_feed("", 0, 1);
+    finsh_log_counters(&written, &dropped, &truncated);
+    TEST_CHECK(truncated == 2);
+    TEST_CHECK(test_count("x") == FINSH_LOG_LINE_MAX);
+
+    test_keys("log\r");
+    TEST_CHECK(test_contains("dropped 3, truncated 2"));
+
+    return test_result();
+}
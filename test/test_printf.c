@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the printf tests
+ */
+
+/*
+ * finsh_printf() against the libc printf, built once with the small printf
+ * of the shell and once with FINSH_USING_LIBC_PRINTF.
+ */
+
+#include "finsh_test.h"
+
+static char expect[8192];
+static const char *zero_precision = "[%08.3u] [%08.3d]";
+static const char *zero_precision_long = "%-300s|%08.3d|";
+
+#define CHECK_FORMAT(...)                                                    \
+    do {                                                                     \
+        int length;                                                          \
+                                                                             \
+        test_clear();                                                        \
+        length = finsh_printf(__VA_ARGS__);                                  \
+        snprintf(expect, sizeof(expect), __VA_ARGS__);                       \
+        TEST_CHECK(strcmp(test_output, expect) == 0);                        \
+        TEST_CHECK(length == (int)strlen(expect));                           \
+    } while (0)
+
+int main(void) {
+    char text[1024];
+    int i;
+
+    test_start(NULL);
+
+    CHECK_FORMAT("plain text");
+    CHECK_FORMAT("%d %i %u %x %X %o %%", -42, 7, 42u, 0xbeefu, 0xbeefu, 8u);
+    CHECK_FORMAT("[%5d] [%-5d] [%05d] [%*d] [%-*d] [%*d]", -42, 42, -42, 6, 1, 6, 1, -6, 1);
+    CHECK_FORMAT("%ld %lu %lld %llu %lx", -1L, 4000000000UL, -1LL, 18446744073709551615ULL, 0xdeadbeefUL);
+    CHECK_FORMAT("%zu %hd %c%c", sizeof(text), (short)-3, 'o', 'k');
+    CHECK_FORMAT("[%s] [%8s] [%-8s] [%.2s] [%*.*s]", "abc", "abc", "abc", "abc", 6, 1, "abc");
+    CHECK_FORMAT("[%.3d] [%.3d] [%8.3d] [%-8.3x] [%.0d] [%5.0u] [%.*d] [%.10lld]", 7, -7, -7, 0xau, 0, 0u, 4, 12, -123LL);
+    CHECK_FORMAT("%-300s|%.3d|%.0x|", "pad", 7, 0u);
+    /* the '0' flag is ignored with a precision, not a literal so gcc does not warn about it */
+    CHECK_FORMAT(zero_precision, 5u, -7);
+    CHECK_FORMAT(zero_precision_long, "pad", -7);
+
+    /* longer than FINSH_CONSOLEBUF_SIZE, nothing is cut */
+    for (i = 0; i < (int)sizeof(text) - 1; i++) text[i] = 'a' + i % 26;
+    text[sizeof(text) - 1] = '\0';
+    CHECK_FORMAT("%s", text);
+    CHECK_FORMAT("head %d [%s] %-300s| tail %u %5.1s %%", 1, text, "pad", 2u, text);
+    CHECK_FORMAT("%300d|%-300x|%0300d|", 12345, 0xabcu, -7);
+    for (i = 0; i < 40; i++) text[i] = 'a' + i % 26;
+    text[40] = '\0';
+    CHECK_FORMAT("%s %s %s %s %d", text, text, text, text, 5);
+#ifdef FINSH_USING_LIBC_PRINTF
+    CHECK_FORMAT("%s %08.3f|%-12e|%+g|%#x|%#010x", text, -3.14159, 2.5e10, 1.0 / 3, 255u, 255u);
+    CHECK_FORMAT("%s %s %s %Lf %p", text, text, text, (long double)1.5, (void *)text);
+#endif
+
+    return test_result();
+}
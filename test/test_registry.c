@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the registry tests
+ */
+
+#include "finsh_test.h"
+#include "msh_rpc.h"
+
+static int named(void *ctx, int argc, char **argv) {
+    (void)argc;
+    finsh_printf("%s=%s\r\n", argv[0], (const char *)ctx);
+    return 0;
+}
+
+static struct msh_cmd cmd_b = {.name = "bravo", .desc = "B.", .func = named, .ctx = "b"};
+static struct msh_cmd cmd_d = {.name = "delta", .desc = "D.", .func = named, .ctx = "d"};
+static struct msh_cmd cmd_a = {.name = "alpha", .desc = "A.", .func = named, .ctx = "a"};
+static struct msh_cmd cmd_c = {.name = "charlie", .desc = "C.", .func = named, .ctx = "c"};
+
+static int counted(void *ctx, int argc, char **argv) {
+    (void)ctx;
+    finsh_printf("%s got %d\r\n", argv[argc - 1], argc);
+    return 0;
+}
+
+static struct msh_cmd cmd_count = {.name = "count", .desc = "Count.", .func = counted, .ctx = NULL};
+
+#define ARG_MAX 12 /* more than FINSH_ARG_MAX */
+
+static void *arena[FINSH_ARENA_BYTES(FINSH_CMD_SIZE, FINSH_HISTORY_LINES, ARG_MAX, FINSH_EXEC_DEPTH, FINSH_CONSOLEBUF_SIZE + 1) /
+                   sizeof(void *)];
+
+/* one request frame, see msh_rpc.h */
+static uint32_t rpc_frame(uint8_t *frame, uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t len) {
+    uint16_t crc;
+
+    frame[0] = FINSH_RPC_SOF;
+    frame[1] = type;
+    frame[2] = seq & 0xFF;
+    frame[3] = seq >> 8;
+    frame[4] = len & 0xFF;
+    frame[5] = len >> 8;
+    memcpy(&frame[FINSH_RPC_HEADER_SIZE], payload, len);
+    crc = finsh_crc16(0xFFFF, &frame[1], FINSH_RPC_HEADER_SIZE - 1 + len);
+    frame[FINSH_RPC_HEADER_SIZE + len] = crc & 0xFF;
+    frame[FINSH_RPC_HEADER_SIZE + len + 1] = crc >> 8;
+
+    return FINSH_RPC_HEADER_SIZE + len + 2;
+}
+
+/* the output holds binary frames, strstr() would stop at the first NUL */
+static int output_has_bytes(const void *buf, uint32_t size) {
+    uint32_t i;
+
+    for (i = 0; i + size <= test_output_size; i++)
+        if (memcmp(test_output + i, buf, size) == 0) return 1;
+
+    return 0;
+}
+
+static int output_has(const char *str) { return output_has_bytes(str, (uint32_t)strlen(str)); }
+
+/* calls the command with id over rpc */
+static void rpc_call_id(uint16_t id) {
+    uint8_t payload[3] = {(uint8_t)(id & 0xFF), (uint8_t)(id >> 8), 0};
+    uint8_t frame[16];
+    uint32_t size = rpc_frame(frame, FINSH_RPC_CALL, 7, payload, sizeof(payload));
+
+    test_feed((const char *)frame, size, 0);
+}
+
+int main(void) {
+    /* the error frame of seq 7 without its crc */
+    static const uint8_t error_id[] = {FINSH_RPC_SOF, FINSH_RPC_ERROR, 7, 0, 1, 0, FINSH_RPC_ERR_ID};
+    uint16_t id_b, id_d;
+    uint8_t frame[16], payload[64], call[80];
+    finsh_shell_cfg_t cfg;
+    int i, pos;
+
+    test_start(NULL);
+
+    TEST_CHECK(msh_cmd_register(&cmd_b) == 0);
+    TEST_CHECK(msh_cmd_register(&cmd_d) == 0);
+    id_b = cmd_b.id;
+    id_d = cmd_d.id;
+    TEST_CHECK(id_b >= MSH_CMD_ID_BASE && id_d >= MSH_CMD_ID_BASE && id_b != id_d);
+
+    /* commands sorted before them do not change their ids */
+    TEST_CHECK(msh_cmd_register(&cmd_a) == 0);
+    TEST_CHECK(msh_cmd_at(0) == &cmd_a);
+    TEST_CHECK(cmd_b.id == id_b && cmd_d.id == id_d);
+    TEST_CHECK(msh_cmd_by_id(id_b) == &cmd_b);
+    TEST_CHECK(msh_cmd_by_id(id_d) == &cmd_d);
+    TEST_CHECK(msh_cmd_by_id(cmd_a.id) == &cmd_a);
+
+    /* an id is not given again right away */
+    TEST_CHECK(msh_cmd_unregister(&cmd_b) == 0);
+    TEST_CHECK(msh_cmd_by_id(id_b) == NULL);
+    TEST_CHECK(msh_cmd_register(&cmd_c) == 0);
+    TEST_CHECK(cmd_c.id != id_b);
+    TEST_CHECK(msh_cmd_by_id(cmd_c.id) == &cmd_c);
+    TEST_CHECK(msh_cmd_by_id(id_d) == &cmd_d);
+
+    /* the rpc ids are the registry ids, a removed id is an error */
+    test_keys("rpc\r");
+    rpc_call_id(id_d);
+    TEST_CHECK(output_has("delta=d"));
+    rpc_call_id(cmd_c.id);
+    TEST_CHECK(output_has("charlie=c"));
+    rpc_call_id(id_b);
+    TEST_CHECK(!output_has("bravo"));
+    TEST_CHECK(output_has_bytes(error_id, sizeof(error_id)));
+    test_feed((const char *)frame, rpc_frame(frame, FINSH_RPC_EXIT, 8, NULL, 0), 0);
+
+    test_keys("delta\r");
+    TEST_CHECK(test_contains("delta=d"));
+
+    /* an rpc call has as many arguments as the shell was given */
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.echo_mode = 1;
+    cfg.prompt_mode = 1;
+    cfg.arena = arena;
+    cfg.arena_size = sizeof(arena);
+    cfg.arg_max = ARG_MAX;
+    TEST_CHECK(test_start(&cfg) == 0);
+    TEST_CHECK(msh_cmd_register(&cmd_count) == 0);
+    payload[0] = cmd_count.id & 0xFF;
+    payload[1] = cmd_count.id >> 8;
+    payload[2] = ARG_MAX - 1;
+    pos = 3;
+    for (i = 1; i < ARG_MAX; i++) pos += snprintf((char *)&payload[pos], sizeof(payload) - pos, "a%02d", i) + 1;
+    test_keys("rpc\r");
+    test_feed((const char *)call, rpc_frame(call, FINSH_RPC_CALL, 9, payload, (uint16_t)pos), 0);
+    TEST_CHECK(output_has("a11 got 12"));
+    payload[2] = ARG_MAX;
+    test_feed((const char *)call, rpc_frame(call, FINSH_RPC_CALL, 9, payload, (uint16_t)pos), 0);
+    TEST_CHECK(!output_has("got 13"));
+    test_feed((const char *)frame, rpc_frame(frame, FINSH_RPC_EXIT, 10, NULL, 0), 0);
+
+    return test_result();
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the replay tests
+ */
+
+#include "finsh_test.h"
+#include "msh_replay.h"
+
+static uint8_t recording[4096];
+static uint32_t recording_size;
+
+static void recording_write(const void *buf, uint32_t size) {
+    if (size > sizeof(recording) - recording_size) size = sizeof(recording) - recording_size;
+    memcpy(recording + recording_size, buf, size);
+    recording_size += size;
+}
+
+int main(void) {
+    static void *arena[FINSH_ARENA_BYTES(FINSH_CMD_SIZE, FINSH_HISTORY_LINES, FINSH_ARG_MAX, FINSH_EXEC_DEPTH,
+                                         FINSH_CONSOLEBUF_SIZE + 1) /
+                       sizeof(void *)];
+    struct finsh_shell *shell;
+    struct finsh_replay replay;
+    finsh_shell_cfg_t cfg;
+
+    test_start(NULL);
+    shell = finsh_shell_current;
+    TEST_CHECK(finsh_record_start(recording_write) == 0);
+    test_keys("help\rnope\r");
+    finsh_record_stop();
+    TEST_CHECK(test_contains("nope: command not found."));
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.echo_mode = 1;
+    cfg.prompt_mode = 1;
+    memset(&replay, 0, sizeof(replay));
+    replay.data = recording;
+    replay.size = recording_size;
+
+    /* the default arena holds the shell of the test */
+    TEST_CHECK(finsh_replay(&cfg, &replay) == -1);
+    TEST_CHECK(finsh_shell_current == shell);
+
+    cfg.arena = arena;
+    cfg.arena_size = sizeof(arena);
+    TEST_CHECK(finsh_replay(&cfg, &replay) == 0);
+    TEST_CHECK(replay.match);
+    TEST_CHECK(replay.keys == 10);
+    TEST_CHECK(replay.commands == 2);
+
+    /* the shell of the test is current again and keeps its history */
+    TEST_CHECK(finsh_shell_current == shell);
+    test_keys("\x1b[A\r");
+    TEST_CHECK(test_contains("nope: command not found."));
+
+    return test_result();
+}
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the shared memory tests
+ */
+
+/*
+ * The shared memory channel against a forked shell: clients which stop
+ * reading, give up, or die holding the lock, and a shell which dies.
+ * Built with FINSH_SHM_TIMEOUT_MS=100.
+ */
+
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "finsh_test.h"
+#include "msh_shm.h"
+
+#define NAME "/finsh_test_shm"
+
+static char reply[32768];
+static uint32_t reply_size;
+static int reply_stall; /* ms the first output callback sleeps */
+
+static int status(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+
+    FINSH_PUTS("status ok\r\n");
+    return 0;
+}
+MSH_CMD_EXPORT(status, print one line);
+
+/* far more output than the ring holds */
+static int flood(int argc, char **argv) {
+    char line[256];
+    int i;
+
+    (void)argc;
+    (void)argv;
+
+    memset(line, 'f', sizeof(line));
+    for (i = 0; i < 64; i++) finsh_write(line, sizeof(line));
+    return 7;
+}
+MSH_CMD_EXPORT(flood, print 16 KB);
+
+static int slow(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+
+    usleep(300 * 1000);
+    FINSH_PUTS("late\r\n");
+    return 3;
+}
+MSH_CMD_EXPORT(slow, answer after 300 ms);
+
+static int shm_getchar(void) {
+    msh_shm_wait(100);
+    return -1;
+}
+
+static void collect(const char *buf, uint32_t size, void *arg) {
+    (void)arg;
+
+    if (reply_stall) {
+        usleep(reply_stall * 1000);
+        reply_stall = 0;
+    }
+    if (size > sizeof(reply) - 1 - reply_size) size = sizeof(reply) - 1 - reply_size;
+    memcpy(&reply[reply_size], buf, size);
+    reply_size += size;
+    reply[reply_size] = '\0';
+}
+
+static int exec(struct finsh_shm *shm, const char *cmd, int *ret, int timeout_ms) {
+    reply_size = 0;
+    reply[0] = '\0';
+    return msh_shm_exec(shm, cmd, collect, NULL, ret, timeout_ms);
+}
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+#define LINE_SIZE 160 /* longer than FINSH_CMD_SIZE */
+
+static void *arena[FINSH_ARENA_BYTES(LINE_SIZE, FINSH_HISTORY_LINES, FINSH_ARG_MAX, FINSH_EXEC_DEPTH, FINSH_CONSOLEBUF_SIZE + 1) /
+                   sizeof(void *)];
+
+static pid_t spawn_shell(void) {
+    int ready[2];
+    char ok = 0;
+    pid_t pid;
+
+    if (pipe(ready) != 0) return -1;
+    pid = fork();
+    if (pid == 0) {
+        finsh_shell_cfg_t cfg;
+
+        memset(&cfg, 0, sizeof(cfg));
+        cfg.get_char = shm_getchar;
+        cfg.arena = arena;
+        cfg.arena_size = sizeof(arena);
+        cfg.line_size = LINE_SIZE;
+        finsh_system_init(&cfg);
+        ok = msh_shm_init(NAME) == 0;
+        if (write(ready[1], &ok, 1) != 1) _exit(1);
+        finsh_run();
+        _exit(0);
+    }
+
+    close(ready[1]);
+    if (read(ready[0], &ok, 1) != 1 || !ok) pid = -1;
+    close(ready[0]);
+
+    return pid;
+}
+
+int main(void) {
+    struct finsh_shm *shm;
+    char line[LINE_SIZE + 2];
+    uint64_t start;
+    pid_t server, client;
+    int ret = -1;
+
+    shm_unlink(NAME);
+    server = spawn_shell();
+    TEST_CHECK(server > 0);
+    shm = msh_shm_open(NAME);
+    TEST_CHECK(shm != NULL);
+    if (server <= 0 || shm == NULL) return test_result();
+
+    TEST_CHECK(exec(shm, "status", &ret, 1000) == 0);
+    TEST_CHECK(ret == 0);
+    TEST_CHECK(strcmp(reply, "status ok\r\n") == 0);
+
+    /* a line is as long as the line of the shell */
+    memset(line, ' ', sizeof(line));
+    memcpy(line, "status", 6);
+    line[LINE_SIZE] = '\0';
+    TEST_CHECK(exec(shm, line, &ret, 1000) == 0);
+    TEST_CHECK(ret == 0);
+    TEST_CHECK(strcmp(reply, "status ok\r\n") == 0);
+    line[LINE_SIZE] = 'x';
+    line[LINE_SIZE + 1] = '\0';
+    TEST_CHECK(exec(shm, line, &ret, 1000) == 0);
+    TEST_CHECK(ret == -1);
+
+    /* a live channel is never taken over */
+    TEST_CHECK(msh_shm_init(NAME) == -1);
+
+    /* a client which stops reading loses output, never the result */
+    reply_stall = 300;
+    TEST_CHECK(exec(shm, "flood", &ret, 5000) == 0);
+    TEST_CHECK(ret == 7);
+    TEST_CHECK(reply_size > 0 && reply_size < 64 * 256);
+    TEST_CHECK(exec(shm, "status", &ret, 1000) == 0);
+    TEST_CHECK(strcmp(reply, "status ok\r\n") == 0);
+
+    /* a client gives up at its timeout, the next one skips the late answer */
+    TEST_CHECK(exec(shm, "slow", &ret, 50) == -1);
+    ret = -1;
+    TEST_CHECK(exec(shm, "status", &ret, 1000) == 0);
+    TEST_CHECK(ret == 0);
+    TEST_CHECK(strcmp(reply, "status ok\r\n") == 0);
+
+    /* a client which dies holding the lock */
+    client = fork();
+    if (client == 0) {
+        struct finsh_shm *own = msh_shm_open(NAME);
+
+        exec(own, "slow", &ret, -1);
+        _exit(0);
+    }
+    usleep(50 * 1000);
+    kill(client, SIGKILL);
+    waitpid(client, NULL, 0);
+    start = now_ms();
+    TEST_CHECK(exec(shm, "status", &ret, 2000) == 0);
+    TEST_CHECK(strcmp(reply, "status ok\r\n") == 0);
+    TEST_CHECK(now_ms() - start < 1000);
+
+    /* a shell which dies ends the wait */
+    kill(server, SIGKILL);
+    waitpid(server, NULL, 0);
+    start = now_ms();
+    TEST_CHECK(exec(shm, "status", &ret, -1) == -1);
+    TEST_CHECK(now_ms() - start < 1000);
+    msh_shm_close(shm);
+
+    /* and its channel is created again */
+    TEST_CHECK(msh_shm_init(NAME) == 0);
+    msh_shm_deinit();
+
+    return test_result();
+}
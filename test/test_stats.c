@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the statistics tests
+ */
+
+#include <stdlib.h>
+
+#include "finsh_test.h"
+#include "msh_stats.h"
+
+static uint32_t clock_now;
+
+/* a 1 MHz clock, moved by the commands only */
+static uint32_t test_clock(void) { return clock_now; }
+
+static int slow(int argc, char **argv) {
+    clock_now += argc > 1 ? (uint32_t)atoi(argv[1]) : 1500;
+    return argc > 2 ? -1 : 0;
+}
+MSH_CMD_EXPORT(slow, take some us);
+
+int main(void) {
+    struct msh_stats stats[FINSH_STATS_MAX];
+    finsh_shell_cfg_t cfg;
+    char line[] = "slow 40";
+    int count, i;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.echo_mode = 1;
+    cfg.prompt_mode = 1;
+    cfg.get_clock = test_clock;
+    cfg.clock_hz = 1000000;
+    test_start(&cfg);
+
+    test_keys("slow\rslow 3\rslow 7 fail\r");
+
+    /* calls of another session, e.g. an rpc client */
+    finsh_set_session(FINSH_SESSION_RPC);
+    msh_exec(line, sizeof(line) - 1);
+    finsh_set_session(FINSH_SESSION_CONSOLE);
+
+    count = msh_stats_snapshot(stats, FINSH_STATS_MAX);
+    for (i = 0; i < count && strcmp(stats[i].name, "slow") != 0; i++);
+    TEST_CHECK(i < count);
+    if (i < count) {
+        TEST_CHECK(stats[i].calls == 4);
+        TEST_CHECK(stats[i].errors == 1);
+        TEST_CHECK(stats[i].session_calls[FINSH_SESSION_CONSOLE] == 3);
+        TEST_CHECK(stats[i].session_calls[FINSH_SESSION_RPC] == 1);
+        TEST_CHECK(stats[i].session_calls[FINSH_SESSION_SHM] == 0);
+        /* sub-tick latencies in us from the high resolution clock */
+        TEST_CHECK(stats[i].max == 1500);
+        TEST_CHECK(stats[i].total == 1500 + 3 + 7 + 40);
+        TEST_CHECK(msh_stats_percentile(&stats[i], 0) == 3);
+        TEST_CHECK(msh_stats_percentile(&stats[i], 1000) == 1500);
+    }
+
+    test_keys("stats\r");
+    TEST_CHECK(test_contains("slow                    4        1      387"));
+    TEST_CHECK(test_contains("     1500     1500             3        1        0\r\n"));
+
+    return test_result();
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     WKJay        first version of the trace tests
+ */
+
+#include "finsh_test.h"
+#include "msh_trace.h"
+
+static uint32_t clock_now = 0xFFFFF000; /* wraps while the test runs */
+static uint32_t clock_step = 1234;
+
+/* a 1 GHz clock, clock_step ns pass between two reads */
+static uint32_t test_clock(void) { return clock_now += clock_step; }
+
+static int lines(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    FINSH_PUTS("one\r\n");
+    FINSH_PUTS("two\r\n");
+    FINSH_PRINTF("%s\r\n", "three");
+    return 0;
+}
+MSH_CMD_EXPORT(lines, print some lines);
+
+int main(void) {
+    finsh_shell_cfg_t cfg;
+    int i;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.echo_mode = 1;
+    cfg.prompt_mode = 1;
+    cfg.get_clock = test_clock;
+    cfg.clock_hz = 1000000000;
+    test_start(&cfg);
+
+    finsh_trace_clear();
+    test_keys("lines\r");
+    test_clear();
+    finsh_trace_dump();
+
+    /* the keys and their echo are one input span */
+    TEST_CHECK(test_count("{\"name\":\"input\",\"ph\":\"B\"") == 1);
+    TEST_CHECK(test_count("{\"name\":\"input\",\"ph\":\"E\"") == 1);
+    /* the prompts and the three lines of the command, one output span each */
+    TEST_CHECK(test_count("{\"name\":\"output\",\"ph\":\"B\"") == 3);
+    TEST_CHECK(test_count("{\"name\":\"lines\",\"ph\":\"B\"") == 1);
+    /* sub-us timestamps across the wrap of the clock */
+    TEST_CHECK(test_contains("\"ts\":12.340,"));
+    TEST_CHECK(!test_contains("\"ts\":4294"));
+
+    /* 21 s of a 1 GHz clock, clocks * 10^9 does not fit 64 bits */
+    finsh_trace_clear();
+    clock_step = 3000000000u;
+    for (i = 0; i < 4; i++) {
+        finsh_trace("step", 'B');
+        finsh_trace("step", 'E');
+    }
+    test_clear();
+    finsh_trace_dump();
+    TEST_CHECK(test_contains("\"ts\":3000000.000,"));
+    TEST_CHECK(test_contains("\"ts\":21000000.000,"));
+
+    return test_result();
+}